@@ -0,0 +1,293 @@
+/** @file CacheSimulator.cpp
+ * @brief A simulator of a hierarchy of CPU caches.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the cache levels and the hierarchy of them.
+ */
+#include "CacheSimulator.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+
+/** cache level constructor
+ * Construct an empty cache level.  The number of sets, the size
+ * divided by the line size and the ways, must be a power of 2 so
+ * that the set of a line is given by its low bits.
+ *
+ * @param name The name of the level, e.g. L1.
+ * @param sizeBytes The capacity of the cache in bytes.
+ * @param lineBytes The size of the cache lines in bytes.
+ * @param ways The number of lines in each set.
+ */
+CacheLevel::CacheLevel(const string& name, long sizeBytes, int lineBytes, int ways)
+{
+  long numSets = (ways > 0 and lineBytes > 0) ? sizeBytes / lineBytes / ways : 0;
+  if (numSets < 1 or numSets * lineBytes * ways != sizeBytes or (numSets & (numSets - 1)) != 0)
+  {
+    cerr << "Error: CacheLevel::CacheLevel() can not have a " << sizeBytes << " byte cache" << endl
+         << "   with " << ways << " ways of " << lineBytes << " byte lines, the number of sets must be a power of 2"
+         << endl;
+    exit(1);
+  }
+
+  this->name = name;
+  this->sizeBytes = sizeBytes;
+  this->ways = ways;
+  setMask = numSets - 1;
+  reset();
+}
+
+
+/** name
+ * @returns const string& The name of the level.
+ */
+const string& CacheLevel::getName() const
+{
+  return name;
+}
+
+
+/** size
+ * @returns long The capacity of the level in bytes.
+ */
+long CacheLevel::getSizeBytes() const
+{
+  return sizeBytes;
+}
+
+
+/** ways
+ * @returns int The number of lines in each set.
+ */
+int CacheLevel::getWays() const
+{
+  return ways;
+}
+
+
+/** reset
+ * Start over with an empty cache and cleared counts.
+ */
+void CacheLevel::reset()
+{
+  lines.assign((setMask + 1) * ways, EMPTY_CACHE_LINE);
+  hits = 0;
+  misses = 0;
+  writebacks = 0;
+}
+
+
+/** write back
+ * A dirty line evicted from the level above is written to this
+ * level.  The whole line is written, so on a miss it is allocated
+ * without being read from the level below.  Write backs are not
+ * counted in the hits and misses, which are those of the references.
+ *
+ * @param line The line address being written back.
+ * @param victimLine Returns the dirty line evicted on a miss, or
+ *   NO_WRITEBACK.
+ *
+ * @returns bool True if the line was already in this level.
+ */
+bool CacheLevel::writeBack(uint64_t line, uint64_t& victimLine)
+{
+  bool hit = lookup(line, true, victimLine);
+  if (victimLine != NO_WRITEBACK)
+  {
+    writebacks++;
+  }
+  return hit;
+}
+
+
+/** hits
+ * @returns long The number of references that hit in this level.
+ */
+long CacheLevel::getHits() const
+{
+  return hits;
+}
+
+
+/** misses
+ * @returns long The number of references that missed in this level.
+ */
+long CacheLevel::getMisses() const
+{
+  return misses;
+}
+
+
+/** write backs
+ * @returns long The number of dirty lines this level evicted.
+ */
+long CacheLevel::getWritebacks() const
+{
+  return writebacks;
+}
+
+
+/** cache simulator constructor
+ * Construct a cache hierarchy with no levels yet, levels are added
+ * from the top (L1) down by addLevel().
+ *
+ * @param lineBytes The size of the cache lines of all of the levels,
+ *   which must be a power of 2.
+ */
+CacheSimulator::CacheSimulator(int lineBytes)
+{
+  if (lineBytes < 1 or (lineBytes & (lineBytes - 1)) != 0)
+  {
+    cerr << "Error: CacheSimulator::CacheSimulator() line size must be" << endl
+         << "   a power of 2, got: " << lineBytes << endl;
+    exit(1);
+  }
+
+  this->lineBytes = lineBytes;
+  lineShift = __builtin_ctz(lineBytes);
+  resetSimulation();
+}
+
+
+/** add level
+ * Add the next level below the current lowest level of the hierarchy.
+ * The levels are named L1, L2, L3... as they are added.
+ *
+ * @param sizeBytes The capacity of the level in bytes.
+ * @param ways The number of lines in each set.
+ */
+void CacheSimulator::addLevel(long sizeBytes, int ways)
+{
+  string name = "L" + to_string(levels.size() + 1);
+  levels.push_back(CacheLevel(name, sizeBytes, lineBytes, ways));
+}
+
+
+/** number of levels
+ * @returns int The number of levels of the hierarchy.
+ */
+int CacheSimulator::getNumLevels() const
+{
+  return levels.size();
+}
+
+
+/** access range
+ * Simulate a read or write of a range of contiguous bytes, which is
+ * one reference to each of the lines the range covers.
+ *
+ * @param address The byte address of the start of the range.
+ * @param numBytes The size of the range in bytes.
+ * @param isWrite True if the range is written.
+ */
+void CacheSimulator::accessRange(uint64_t address, long numBytes, bool isWrite)
+{
+  uint64_t lastLine = (address + numBytes - 1) >> lineShift;
+  for (uint64_t line = address >> lineShift; line <= lastLine; line++)
+  {
+    access(line << lineShift, isWrite);
+  }
+}
+
+
+/** fill
+ * A line missed in the level above, read it from this level, or
+ * from further down on a miss here too.  The dirty line the level
+ * above evicted to make room is written back to this level first.
+ *
+ * @param level The level to read the line from, the number of levels
+ *   for memory.
+ * @param line The line address that missed.
+ * @param writebackLine The dirty line evicted by the level above, or
+ *   NO_WRITEBACK.
+ */
+void CacheSimulator::fill(int level, uint64_t line, uint64_t writebackLine)
+{
+  if (writebackLine != NO_WRITEBACK)
+  {
+    writeBack(level, writebackLine);
+  }
+
+  if (level == int(levels.size()))
+  {
+    memoryReads++;
+    return;
+  }
+
+  uint64_t victimLine;
+  if (not levels[level].access(line, false, victimLine))
+  {
+    fill(level + 1, line, victimLine);
+  }
+}
+
+
+/** write back
+ * Write a dirty line back to the indicated level, or to memory below
+ * the last level.  Allocating the line may in turn evict a dirty line
+ * of this level, which is written back further down.
+ *
+ * @param level The level to write the line to, the number of levels
+ *   for memory.
+ * @param line The line address being written back.
+ */
+void CacheSimulator::writeBack(int level, uint64_t line)
+{
+  if (level == int(levels.size()))
+  {
+    memoryWrites++;
+    return;
+  }
+
+  uint64_t victimLine;
+  levels[level].writeBack(line, victimLine);
+  if (victimLine != NO_WRITEBACK)
+  {
+    writeBack(level + 1, victimLine);
+  }
+}
+
+
+/** display results
+ * Display the hits, misses and write backs of each level, and the
+ * lines read from and written to memory.
+ */
+void CacheSimulator::displayResults()
+{
+  ostringstream out;
+  out << "<CacheSimulator> cache simulation ends" << "\n"
+      << "    Line size: " << lineBytes << " bytes" << "\n";
+
+  for (const CacheLevel& level : levels)
+  {
+    long references = level.getHits() + level.getMisses();
+    out << "    " << level.getName() << " " << level.getSizeBytes() << " bytes " << level.getWays() << " ways"
+        << " hits: " << level.getHits() << " misses: " << level.getMisses()
+        << " miss rate: " << ((references == 0) ? 0.0 : double(level.getMisses()) / references)
+        << " write backs: " << level.getWritebacks() << "\n";
+  }
+  out << "    Memory lines read: " << memoryReads << " written: " << memoryWrites << "\n";
+
+  cout << out.str() << flush;
+}
+
+
+/** reset simulation
+ * Start over with empty caches and cleared counts, keeping the levels.
+ */
+void CacheSimulator::resetSimulation()
+{
+  for (CacheLevel& level : levels)
+  {
+    level.reset();
+  }
+  memoryReads = 0;
+  memoryWrites = 0;
+}
@@ -0,0 +1,200 @@
+/** @file CacheSimulator.hpp
+ * @brief A simulator of a hierarchy of CPU caches.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Locality matters at the granularity of cache lines as well as
+ * pages.  This simulates the L1, L2 and last level caches a CPU puts
+ * in front of memory, driven by the same stream of matrix element
+ * references as the paging simulator, so the loop orders can be
+ * compared by their cache misses as well as their page faults.
+ *
+ * Each level is a set associative cache with least recently used
+ * replacement within a set.  The caches are write-back and
+ * write-allocate, a write only marks the line dirty, and a dirty line
+ * is written to the next level down when it is evicted.
+ */
+#ifndef CACHE_SIMULATOR_HPP
+#define CACHE_SIMULATOR_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// cache lines are 64 bytes by default, as on most current CPUs
+const int DEFAULT_CACHE_LINE_BYTES = 64;
+/// the contents of an empty cache line slot
+const uint64_t EMPTY_CACHE_LINE = ~uint64_t(0);
+/// indicates no dirty line was evicted by an access
+const uint64_t NO_WRITEBACK = ~uint64_t(0);
+
+/** @class CacheLevel
+ * @brief One level of a cache hierarchy
+ *
+ * The lines of all of the sets are kept in one flat array, the
+ * lines of set s are at s * ways to s * ways + ways - 1, ordered from
+ * most to least recently used.  Each slot packs the line address
+ * (the address shifted right by the line size bits) with a dirty bit
+ * in the low bit, so a lookup is a short scan of a few words and no
+ * memory is allocated once the cache is constructed.
+ */
+class CacheLevel
+{
+private:
+  string name;
+  long sizeBytes;
+  int ways;
+  uint64_t setMask;
+  vector<uint64_t> lines;
+
+  long hits;
+  long misses;
+  long writebacks;
+
+  bool lookup(uint64_t line, bool isWrite, uint64_t& victimLine);
+
+public:
+  CacheLevel(const string& name, long sizeBytes, int lineBytes, int ways);
+  const string& getName() const;
+  long getSizeBytes() const;
+  int getWays() const;
+  void reset();
+  bool access(uint64_t line, bool isWrite, uint64_t& victimLine);
+  bool writeBack(uint64_t line, uint64_t& victimLine);
+  long getHits() const;
+  long getMisses() const;
+  long getWritebacks() const;
+};
+
+/** @class CacheSimulator
+ * @brief A hierarchy of cache levels in front of memory
+ *
+ * References are made by byte address.  The first level is looked
+ * up inline, only misses leave the inline path to go to the lower
+ * levels, and then memory, which only counts the lines read and
+ * written.
+ */
+class CacheSimulator
+{
+private:
+  int lineBytes;
+  int lineShift;
+  vector<CacheLevel> levels;
+  long memoryReads;
+  long memoryWrites;
+
+  void fill(int level, uint64_t line, uint64_t writebackLine);
+  void writeBack(int level, uint64_t line);
+
+public:
+  CacheSimulator(int lineBytes = DEFAULT_CACHE_LINE_BYTES);
+  void addLevel(long sizeBytes, int ways);
+  int getNumLevels() const;
+  void access(uint64_t address, bool isWrite);
+  void accessRange(uint64_t address, long numBytes, bool isWrite);
+  void displayResults();
+  void resetSimulation();
+};
+
+
+/** lookup
+ * Look up a line in its set.  On a hit the line becomes the most
+ * recently used of the set, and on a miss it replaces the least
+ * recently used line.  Either way it is marked dirty by a write.
+ *
+ * @param line The line address being referenced.
+ * @param isWrite True if the line is being written.
+ * @param victimLine Returns the line address of the dirty line
+ *   evicted to make room on a miss, or NO_WRITEBACK if there was none.
+ *
+ * @returns bool True on a hit, false on a miss.
+ */
+inline bool CacheLevel::lookup(uint64_t line, bool isWrite, uint64_t& victimLine)
+{
+  uint64_t* set = &lines[(line & setMask) * ways];
+  uint64_t key = line << 1;
+
+  int way = 0;
+  while (way < ways and (set[way] & ~uint64_t(1)) != key)
+  {
+    way++;
+  }
+
+  bool hit = (way < ways);
+  uint64_t slot;
+  if (hit)
+  {
+    slot = set[way] | uint64_t(isWrite);
+    victimLine = NO_WRITEBACK;
+  }
+  else
+  {
+    way = ways - 1;
+    slot = key | uint64_t(isWrite);
+    uint64_t victim = set[way];
+    victimLine = (victim != EMPTY_CACHE_LINE and (victim & 1)) ? victim >> 1 : NO_WRITEBACK;
+  }
+
+  // move the line to the front of the set, as the most recently used
+  for (; way > 0; way--)
+  {
+    set[way] = set[way - 1];
+  }
+  set[0] = slot;
+  return hit;
+}
+
+
+/** access
+ * A read or write of a line by the level above, counted in the hits
+ * and misses of this level.
+ *
+ * @param line The line address being referenced.
+ * @param isWrite True if the line is being written.
+ * @param victimLine Returns the dirty line evicted on a miss, or
+ *   NO_WRITEBACK.
+ *
+ * @returns bool True on a hit, false on a miss.
+ */
+inline bool CacheLevel::access(uint64_t line, bool isWrite, uint64_t& victimLine)
+{
+  bool hit = lookup(line, isWrite, victimLine);
+  if (hit)
+  {
+    hits++;
+  }
+  else
+  {
+    misses++;
+  }
+  if (victimLine != NO_WRITEBACK)
+  {
+    writebacks++;
+  }
+  return hit;
+}
+
+
+/** access
+ * Simulate a read or write of the indicated byte address.  This is
+ * the fast path, called on every reference, and only a miss in the
+ * first level leaves it.
+ *
+ * @param address The byte address being referenced.
+ * @param isWrite True if the reference is a write.
+ */
+inline void CacheSimulator::access(uint64_t address, bool isWrite)
+{
+  uint64_t line = address >> lineShift;
+  uint64_t victimLine;
+  if (not levels[0].access(line, isWrite, victimLine))
+  {
+    fill(1, line, victimLine);
+  }
+}
+
+#endif // CACHE_SIMULATOR_HPP
@@ -0,0 +1,430 @@
+/** @file CompressedTier.cpp
+ * @brief A compressed memory tier for the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the LZ codec and the compressed tier.
+ */
+#include "CompressedTier.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+/// the number of bits of the hash of 4 bytes used to find matches
+const int LZ_HASH_BITS = 12;
+/// the largest length held in a nibble of a sequence token, longer
+/// lengths continue in the bytes that follow
+const int LZ_TOKEN_LENGTH = 15;
+
+
+/** read 32 bits
+ * Read 4 bytes, in any alignment.
+ *
+ * @param bytes The bytes to read.
+ *
+ * @returns uint32_t The 4 bytes as a word.
+ */
+static inline uint32_t read32(const unsigned char* bytes)
+{
+  uint32_t word;
+  memcpy(&word, bytes, sizeof(word));
+  return word;
+}
+
+
+/** write length
+ * Write the part of a length that does not fit in its token nibble,
+ * as bytes of 255 followed by the remainder.
+ *
+ * @param length The length less the token nibble.
+ * @param output The output to append to.
+ */
+static void writeLength(int length, vector<unsigned char>& output)
+{
+  while (length >= 255)
+  {
+    output.push_back(255);
+    length -= 255;
+  }
+  output.push_back(length);
+}
+
+
+/** write sequence
+ * Write a sequence of literal bytes followed by a match, or just the
+ * literals at the end of the input when the match length is 0.
+ *
+ * @param literals The literal bytes.
+ * @param numLiterals The number of literal bytes.
+ * @param offset How far back the match starts.
+ * @param matchLength The length of the match, or 0 for none.
+ * @param output The output to append to.
+ */
+static void writeSequence(const unsigned char* literals, int numLiterals, int offset, int matchLength,
+                          vector<unsigned char>& output)
+{
+  int matchCode = (matchLength == 0) ? 0 : matchLength - LZ_MIN_MATCH;
+  output.push_back((min(numLiterals, LZ_TOKEN_LENGTH) << 4) | min(matchCode, LZ_TOKEN_LENGTH));
+  if (numLiterals >= LZ_TOKEN_LENGTH)
+  {
+    writeLength(numLiterals - LZ_TOKEN_LENGTH, output);
+  }
+  output.insert(output.end(), literals, literals + numLiterals);
+
+  if (matchLength > 0)
+  {
+    output.push_back(offset & 0xff);
+    output.push_back(offset >> 8);
+    if (matchCode >= LZ_TOKEN_LENGTH)
+    {
+      writeLength(matchCode - LZ_TOKEN_LENGTH, output);
+    }
+  }
+}
+
+
+/** read length
+ * Read the part of a length that continues after its token nibble.
+ *
+ * @param input The position in the input, advanced past the length.
+ * @param end The end of the input.
+ * @param length The length to add to.
+ *
+ * @returns bool False if the input ends in the middle of the length.
+ */
+static bool readLength(const unsigned char*& input, const unsigned char* end, int& length)
+{
+  unsigned char byte;
+  do
+  {
+    if (input >= end)
+    {
+      return false;
+    }
+    byte = *input++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+
+/** LZ compress
+ * Compress a block of bytes.  Each sequence of the output is a token
+ * byte holding the number of literal bytes and the length of the
+ * match that follows them, the literal bytes, and the 16 bit offset
+ * back to the match.  The last sequence has only literals.  Matches
+ * are found by hashing the next 4 bytes, remembering only the last
+ * position of each hash, so compression is a single fast pass.
+ *
+ * @param input The bytes to compress.
+ * @param inputBytes The number of bytes to compress.
+ * @param output Returns the compressed bytes.
+ *
+ * @returns int The number of compressed bytes.
+ */
+int lzCompress(const unsigned char* input, int inputBytes, vector<unsigned char>& output)
+{
+  int lastPosition[1 << LZ_HASH_BITS];
+  for (int& position : lastPosition)
+  {
+    position = -1;
+  }
+  output.clear();
+
+  int anchor = 0;
+  int position = 0;
+  while (position + LZ_MIN_MATCH <= inputBytes)
+  {
+    uint32_t sequence = read32(input + position);
+    int hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+    int candidate = lastPosition[hash];
+    lastPosition[hash] = position;
+
+    if (candidate < 0 or position - candidate > LZ_MAX_OFFSET or read32(input + candidate) != sequence)
+    {
+      position++;
+      continue;
+    }
+
+    int matchLength = LZ_MIN_MATCH;
+    while (position + matchLength < inputBytes and input[candidate + matchLength] == input[position + matchLength])
+    {
+      matchLength++;
+    }
+    writeSequence(input + anchor, position - anchor, position - candidate, matchLength, output);
+    position += matchLength;
+    anchor = position;
+  }
+
+  writeSequence(input + anchor, inputBytes - anchor, 0, 0, output);
+  return output.size();
+}
+
+
+/** LZ decompress
+ * Decompress a block of bytes compressed by lzCompress().
+ *
+ * @param input The compressed bytes.
+ * @param inputBytes The number of compressed bytes.
+ * @param output Returns the decompressed bytes.
+ * @param outputBytes The room for decompressed bytes in the output.
+ *
+ * @returns int The number of decompressed bytes, or -1 if the input
+ *   is not valid or does not fit in the output.
+ */
+int lzDecompress(const unsigned char* input, int inputBytes, unsigned char* output, int outputBytes)
+{
+  const unsigned char* end = input + inputBytes;
+  int position = 0;
+  while (input < end)
+  {
+    int token = *input++;
+    int numLiterals = token >> 4;
+    if (numLiterals == LZ_TOKEN_LENGTH and not readLength(input, end, numLiterals))
+    {
+      return -1;
+    }
+    if (numLiterals > end - input or numLiterals > outputBytes - position)
+    {
+      return -1;
+    }
+    memcpy(output + position, input, numLiterals);
+    input += numLiterals;
+    position += numLiterals;
+
+    // the last sequence has no match
+    if (input == end)
+    {
+      break;
+    }
+
+    if (end - input < 2)
+    {
+      return -1;
+    }
+    int offset = input[0] | (input[1] << 8);
+    input += 2;
+    int matchLength = token & LZ_TOKEN_LENGTH;
+    if (matchLength == LZ_TOKEN_LENGTH and not readLength(input, end, matchLength))
+    {
+      return -1;
+    }
+    matchLength += LZ_MIN_MATCH;
+    if (offset == 0 or offset > position or matchLength > outputBytes - position)
+    {
+      return -1;
+    }
+
+    // the match may overlap the bytes it is writing, so copy a byte
+    // at a time
+    for (int byte = 0; byte < matchLength; byte++)
+    {
+      output[position + byte] = output[position - offset + byte];
+    }
+    position += matchLength;
+  }
+  return position;
+}
+
+
+/** compressed tier constructor
+ * There is no tier until it is configured with a capacity.
+ */
+CompressedTier::CompressedTier()
+{
+  capacityBytes = 0;
+  reset();
+}
+
+
+/** configure tier
+ * Set the capacity of the tier, and empty it.
+ *
+ * @param capacityBytes The most compressed bytes the tier holds, 0
+ *   for no tier.
+ */
+void CompressedTier::configure(long capacityBytes)
+{
+  this->capacityBytes = capacityBytes;
+  reset();
+}
+
+
+/** reset tier
+ * Empty the tier and start the counts over.
+ */
+void CompressedTier::reset()
+{
+  storedBytes = 0;
+  pages.clear();
+  storeOrder.clear();
+  pagesStored = 0;
+  pagesRejected = 0;
+  pagesSpilled = 0;
+  hits = 0;
+  misses = 0;
+  uncompressedBytes = 0;
+  compressedBytes = 0;
+  compressSeconds = 0.0;
+  decompressSeconds = 0.0;
+}
+
+
+/** get capacity
+ * @returns long The most compressed bytes the tier holds, 0 if there
+ *   is no tier.
+ */
+long CompressedTier::getCapacity() const
+{
+  return capacityBytes;
+}
+
+
+/** store page
+ * Compress a page that is being replaced into the tier, spilling the
+ * least recently stored pages to disk until it fits.
+ *
+ * @param key The page being stored.
+ * @param page The contents of the page.
+ * @param pageBytes The size of the page.
+ * @param dirty True if the page has to be written to disk when it
+ *   leaves the tier.
+ *
+ * @returns int The number of dirty pages written to disk, the pages
+ *   spilled and the page itself if it was rejected.
+ */
+int CompressedTier::store(long key, const unsigned char* page, int pageBytes, bool dirty)
+{
+  // a page is only ever stored once, but make sure a stale copy is
+  // never left behind
+  unordered_map<long, CompressedPage>::iterator it = pages.find(key);
+  if (it != pages.end())
+  {
+    storedBytes -= it->second.data.size();
+    storeOrder.erase(it->second.position);
+    pages.erase(it);
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  int numBytes = lzCompress(page, pageBytes, compressBuffer);
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  compressSeconds += elapsed.count();
+
+  if (numBytes >= pageBytes or numBytes > capacityBytes)
+  {
+    pagesRejected++;
+    return dirty ? 1 : 0;
+  }
+  pagesStored++;
+  uncompressedBytes += pageBytes;
+  compressedBytes += numBytes;
+
+  int dirtyWritten = 0;
+  while (storedBytes + numBytes > capacityBytes)
+  {
+    CompressedPage& oldest = pages[storeOrder.front()];
+    storedBytes -= oldest.data.size();
+    if (oldest.dirty)
+    {
+      dirtyWritten++;
+    }
+    pages.erase(storeOrder.front());
+    storeOrder.pop_front();
+    pagesSpilled++;
+  }
+
+  CompressedPage& stored = pages[key];
+  stored.data.assign(compressBuffer.begin(), compressBuffer.end());
+  stored.dirty = dirty;
+  stored.position = storeOrder.insert(storeOrder.end(), key);
+  storedBytes += numBytes;
+  return dirtyWritten;
+}
+
+
+/** load page
+ * Look for a page that is faulting in the tier, and if it is there
+ * decompress it and remove it from the tier.
+ *
+ * @param key The page being loaded.
+ * @param page Returns the contents of the page.
+ * @param pageBytes The size of the page.
+ * @param dirty Returns true if the page had not been written to disk.
+ *
+ * @returns bool True if the page was in the tier.
+ */
+bool CompressedTier::load(long key, unsigned char* page, int pageBytes, bool& dirty)
+{
+  unordered_map<long, CompressedPage>::iterator it = pages.find(key);
+  if (it == pages.end())
+  {
+    misses++;
+    return false;
+  }
+
+  CompressedPage& stored = it->second;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  int numBytes = lzDecompress(stored.data.data(), stored.data.size(), page, pageBytes);
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  decompressSeconds += elapsed.count();
+  if (numBytes != pageBytes)
+  {
+    cerr << "Error: CompressedTier::load() page did not decompress to " << pageBytes << " bytes" << endl;
+    exit(1);
+  }
+
+  hits++;
+  dirty = stored.dirty;
+  storedBytes -= stored.data.size();
+  storeOrder.erase(stored.position);
+  pages.erase(it);
+  return true;
+}
+
+
+/** get hits
+ * @returns long The number of faults served from the tier.
+ */
+long CompressedTier::getHits() const
+{
+  return hits;
+}
+
+
+/** get pages stored
+ * @returns long The number of pages compressed into the tier.
+ */
+long CompressedTier::getPagesStored() const
+{
+  return pagesStored;
+}
+
+
+/** display results
+ * Display how well the pages compressed, and how many faults the tier
+ * served.
+ *
+ * @param out The stream to display the results on.
+ */
+void CompressedTier::displayResults(ostream& out) const
+{
+  long lookups = hits + misses;
+  out << "    Compressed tier: " << capacityBytes << " bytes, holding " << pages.size() << " pages in " << storedBytes
+      << " bytes" << "\n"
+      << "    Tier pages stored: " << pagesStored << " rejected: " << pagesRejected << " spilled: " << pagesSpilled
+      << "\n"
+      << "    Tier hits: " << hits << " misses: " << misses
+      << " hit rate: " << ((lookups == 0) ? 0.0 : double(hits) / lookups) << "\n"
+      << "    Compression ratio: " << ((compressedBytes == 0) ? 0.0 : double(uncompressedBytes) / compressedBytes)
+      << "\n"
+      << "    Compress time: " << compressSeconds << " seconds decompress time: " << decompressSeconds << " seconds"
+      << "\n";
+}
@@ -0,0 +1,89 @@
+/** @file CompressedTier.hpp
+ * @brief A compressed memory tier for the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * A pool of compressed pages between the resident frames and the
+ * disk, as zswap keeps in front of swap.  Pages replaced by the
+ * DynamicPagingSimulator are compressed into the tier, and a later
+ * fault on a page in the tier decompresses it instead of reading it
+ * from disk.  When the tier is full the least recently stored pages
+ * are spilled to disk.  The contents of the pages are really
+ * compressed, with a small LZ77 codec in the style of LZ4, so the
+ * compression ratio and the time spent compressing are those of the
+ * actual matrix contents.
+ */
+#ifndef COMPRESSED_TIER_HPP
+#define COMPRESSED_TIER_HPP
+#include <list>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/// the shortest match the codec encodes
+const int LZ_MIN_MATCH = 4;
+/// the farthest back a match can be, offsets are 16 bits
+const int LZ_MAX_OFFSET = 65535;
+
+int lzCompress(const unsigned char* input, int inputBytes, vector<unsigned char>& output);
+int lzDecompress(const unsigned char* input, int inputBytes, unsigned char* output, int outputBytes);
+
+/** Compressed page
+ * A page held in the compressed tier.
+ */
+struct CompressedPage
+{
+  /// the compressed contents of the page
+  vector<unsigned char> data;
+  /// true if the page has to be written to disk when it is spilled
+  bool dirty;
+  /// the position of the page in the order pages were stored
+  list<long>::iterator position;
+};
+
+/** @class CompressedTier
+ * @brief Compressed pages between memory and disk
+ *
+ * Pages are identified by a key chosen by the simulator.  A page
+ * that does not compress to less than a page is rejected and goes
+ * straight to disk, as zswap rejects it.
+ */
+class CompressedTier
+{
+private:
+  /// the most compressed bytes the tier holds, 0 if there is no tier
+  long capacityBytes;
+  long storedBytes;
+  unordered_map<long, CompressedPage> pages;
+  /// keys of the stored pages, least recently stored first
+  list<long> storeOrder;
+  vector<unsigned char> compressBuffer;
+
+  long pagesStored;
+  long pagesRejected;
+  long pagesSpilled;
+  long hits;
+  long misses;
+  long uncompressedBytes;
+  long compressedBytes;
+  double compressSeconds;
+  double decompressSeconds;
+
+public:
+  CompressedTier();
+  void configure(long capacityBytes);
+  void reset();
+  long getCapacity() const;
+  int store(long key, const unsigned char* page, int pageBytes, bool dirty);
+  bool load(long key, unsigned char* page, int pageBytes, bool& dirty);
+  long getHits() const;
+  long getPagesStored() const;
+  void displayResults(ostream& out) const;
+};
+
+#endif // COMPRESSED_TIER_HPP
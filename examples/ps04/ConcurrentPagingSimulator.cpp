@@ -0,0 +1,246 @@
+/** @file ConcurrentPagingSimulator.cpp
+ * @brief A paging simulator that can be driven from many threads.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the sharded concurrent paging simulator.
+ */
+#include "ConcurrentPagingSimulator.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+
+/** concurrent paging simulator constructor
+ * @param numFrames The number of physical frames in the frame pool.
+ * @param policyName The replacement policy each shard uses within its
+ *   frames, one of fifo, lru or clock.  OPT needs the global reference
+ *   string in advance, so it is not possible here.
+ */
+ConcurrentPagingSimulator::ConcurrentPagingSimulator(int numFrames, const string& policyName)
+{
+  vector<PageReference> noReferences;
+  PageReplacementPolicy* policy = makeReplacementPolicy(policyName, noReferences);
+  if (numFrames < 1 or policy == NULL or policyName == "opt")
+  {
+    cerr << "Error: ConcurrentPagingSimulator::ConcurrentPagingSimulator() can not simulate " << numFrames << endl
+         << "   frames with the " << policyName << " policy" << endl;
+    exit(1);
+  }
+  delete policy;
+
+  this->numFrames = numFrames;
+  this->policyName = policyName;
+  FrameTableEntry freeFrame = {NO_PROCESS, NO_PAGE, false};
+  frameTable.assign(numFrames, freeFrame);
+  nextFreeFrame = 0;
+}
+
+
+/** concurrent paging simulator destructor
+ * Free up the shards and their policies.
+ */
+ConcurrentPagingSimulator::~ConcurrentPagingSimulator()
+{
+  for (PageTableShard* shard : shards)
+  {
+    delete shard->policy;
+    delete shard;
+  }
+}
+
+
+/** add process
+ * Add the shard of a new process, with all of its pages not present.
+ * There must be at least one frame for each process, so that a shard
+ * can always steal a frame from another.
+ *
+ * @param processId The id of the new process, they must be added in
+ *   order from 0.
+ * @param processName The name of the process, e.g. A, B or C.
+ * @param numPages The number of virtual pages of the process.
+ */
+void ConcurrentPagingSimulator::addProcess(int processId, const string& processName, int numPages)
+{
+  if (processId != int(shards.size()) or processId >= numFrames)
+  {
+    cerr << "Error: ConcurrentPagingSimulator::addProcess() can not add process " << processId << endl
+         << "   with " << shards.size() << " processes and " << numFrames << " frames" << endl;
+    exit(1);
+  }
+
+  vector<PageReference> noReferences;
+  PageTableEntry notPresent = {false, NO_FRAME, false, false, false, false};
+  PageTableShard* shard = new PageTableShard();
+  shard->name = processName;
+  shard->pageTable.assign(numPages, notPresent);
+  shard->policy = makeReplacementPolicy(policyName, noReferences);
+  shard->policy->reset(numFrames);
+  shard->numFramesHeld = 0;
+  shard->hits = 0;
+  shard->faults = 0;
+  shard->framesStolen = 0;
+  shards.push_back(shard);
+}
+
+
+/** reference page
+ * Simulate a reference by a process to one of its pages.  This may be
+ * called from any number of threads at once, only the lock of the
+ * shard of the process is held, except to steal a frame.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ */
+void ConcurrentPagingSimulator::referencePage(int processId, int pageNumber)
+{
+  PageTableShard& shard = *shards[processId];
+  lock_guard<mutex> guard(shard.lock);
+
+  PageTableEntry& entry = shard.pageTable[pageNumber];
+  if (entry.present)
+  {
+    shard.hits++;
+    shard.policy->pageReferenced(entry.frame);
+    return;
+  }
+
+  shard.faults++;
+  int frame = allocateFrame(processId);
+  entry.present = true;
+  entry.frame = frame;
+  frameTable[frame].processId = processId;
+  frameTable[frame].pageNumber = pageNumber;
+  shard.policy->pageLoaded(frame);
+}
+
+
+/** allocate frame
+ * Find a frame for a page fault of a process, whose shard lock is
+ * held.  A never used frame is taken from the global pool if there
+ * are any left, otherwise a page of the shard is replaced, or if the
+ * shard has no frames one is stolen from another shard.
+ *
+ * @param processId The id of the process that faulted.
+ *
+ * @returns int The frame for the new page.
+ */
+int ConcurrentPagingSimulator::allocateFrame(int processId)
+{
+  PageTableShard& shard = *shards[processId];
+
+  // check first so the pool counter is not incremented past the end
+  // by every fault once it is used up
+  if (nextFreeFrame.load(memory_order_relaxed) < numFrames)
+  {
+    int frame = nextFreeFrame.fetch_add(1, memory_order_relaxed);
+    if (frame < numFrames)
+    {
+      shard.numFramesHeld++;
+      return frame;
+    }
+  }
+
+  if (shard.numFramesHeld > 0)
+  {
+    int frame = shard.policy->selectVictim(NO_PINNED_FRAME);
+    evictFrame(shard, frame);
+    return frame;
+  }
+
+  return stealFrame(processId);
+}
+
+
+/** steal frame
+ * Take the victim frame of another shard that holds more than one
+ * frame.  We already hold the lock of our own shard, so the locks of
+ * the others are only tried, never waited for, so two stealing shards
+ * can not deadlock.  There is at least one frame for each process, so
+ * while we hold none some other shard holds more than one.
+ *
+ * @param processId The id of the process that faulted.
+ *
+ * @returns int The stolen frame.
+ */
+int ConcurrentPagingSimulator::stealFrame(int processId)
+{
+  int numShards = shards.size();
+  while (true)
+  {
+    for (int offset = 1; offset < numShards; offset++)
+    {
+      PageTableShard& other = *shards[(processId + offset) % numShards];
+      if (not other.lock.try_lock())
+      {
+        continue;
+      }
+
+      if (other.numFramesHeld > 1)
+      {
+        int frame = other.policy->selectVictim(NO_PINNED_FRAME);
+        evictFrame(other, frame);
+        other.numFramesHeld--;
+        other.lock.unlock();
+
+        PageTableShard& shard = *shards[processId];
+        shard.numFramesHeld++;
+        shard.framesStolen++;
+        return frame;
+      }
+      other.lock.unlock();
+    }
+    this_thread::yield();
+  }
+}
+
+
+/** evict frame
+ * The page in a frame of a shard, whose lock is held, is replaced, so
+ * it is no longer present.
+ *
+ * @param shard The shard holding the frame.
+ * @param frame The frame being replaced.
+ */
+void ConcurrentPagingSimulator::evictFrame(PageTableShard& shard, int frame)
+{
+  PageTableEntry& victim = shard.pageTable[frameTable[frame].pageNumber];
+  victim.present = false;
+  victim.frame = NO_FRAME;
+}
+
+
+/** display results
+ * Display the hits and faults of each process and in total, and how
+ * the frames ended up shared out.  Only to be called once no more
+ * references are being made.
+ */
+void ConcurrentPagingSimulator::displayResults()
+{
+  long totalHits = 0;
+  long totalFaults = 0;
+  for (PageTableShard* shard : shards)
+  {
+    totalHits += shard->hits;
+    totalFaults += shard->faults;
+  }
+
+  ostringstream out;
+  out << "<ConcurrentPagingSimulator> paging simulation ends" << "\n"
+      << "    Replacement policy: local " << policyName << " with " << numFrames << " frames" << "\n"
+      << "    Total number of page hits seen: " << totalHits << "\n"
+      << "    Total number of page faults seen: " << totalFaults << "\n";
+  for (PageTableShard* shard : shards)
+  {
+    out << "    Matrix " << shard->name << " hits: " << shard->hits << " faults: " << shard->faults
+        << " frames: " << shard->numFramesHeld << " stolen: " << shard->framesStolen << "\n";
+  }
+
+  cout << out.str() << flush;
+}
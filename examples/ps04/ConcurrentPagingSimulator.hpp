@@ -0,0 +1,92 @@
+/** @file ConcurrentPagingSimulator.hpp
+ * @brief A paging simulator that can be driven from many threads.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * The DynamicPagingSimulator keeps one set of tables for all of the
+ * processes, and so can only be driven by one thread.  This simulator
+ * splits them up so that the references of different processes can
+ * be simulated by different threads at the same time.
+ *
+ * Each process owns a shard, its page table, its own replacement
+ * policy and its counts, protected by a lock of its own, so threads
+ * simulating different processes do not contend.  The frames start
+ * out in a global pool, and are handed out to the shards that fault
+ * with a single atomic increment, without a lock.  Once the pool is
+ * used up each shard replaces pages within the frames it holds, local
+ * replacement rather than the global replacement of the
+ * DynamicPagingSimulator.  A shard that faults holding no frames
+ * steals the victim of another shard that holds more than one.
+ *
+ * Which shard gets the frames of the pool, and so the faults of each
+ * process, depends on how the threads happen to run, so the results
+ * of concurrent runs can vary a little.
+ */
+#ifndef CONCURRENT_PAGING_SIMULATOR_HPP
+#define CONCURRENT_PAGING_SIMULATOR_HPP
+#include "DynamicPagingSimulator.hpp"
+#include "PageReplacementPolicy.hpp"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** Page table shard
+ * The page table of a single process, with everything needed to
+ * simulate its references, protected by its own lock.  Aligned to a
+ * cache line so the counts of different shards, updated by different
+ * threads, do not share cache lines.
+ */
+struct alignas(64) PageTableShard
+{
+  mutex lock;
+  string name;
+  vector<PageTableEntry> pageTable;
+  /// replacement policy over the frames held by this shard
+  PageReplacementPolicy* policy;
+  int numFramesHeld;
+  long hits;
+  long faults;
+  long framesStolen;
+};
+
+/** @class ConcurrentPagingSimulator
+ * @brief Simulate paging with a page table shard for each process
+ *
+ * Processes are added before any references are made, which is not
+ * thread safe.  Then referencePage() may be called from any number of
+ * threads at once.
+ */
+class ConcurrentPagingSimulator
+{
+private:
+  int numFrames;
+  string policyName;
+  vector<PageTableShard*> shards;
+
+  /// which page of which process is in each frame, only touched while
+  /// holding the lock of the shard holding the frame
+  vector<FrameTableEntry> frameTable;
+  /// the next frame of the global pool that has never been used
+  atomic<int> nextFreeFrame;
+
+  int allocateFrame(int processId);
+  int stealFrame(int processId);
+  void evictFrame(PageTableShard& shard, int frame);
+
+public:
+  ConcurrentPagingSimulator(int numFrames, const string& policyName);
+  ~ConcurrentPagingSimulator();
+  ConcurrentPagingSimulator(const ConcurrentPagingSimulator&) = delete;
+  ConcurrentPagingSimulator& operator=(const ConcurrentPagingSimulator&) = delete;
+  void addProcess(int processId, const string& processName, int numPages);
+  void referencePage(int processId, int pageNumber);
+  void displayResults();
+};
+
+#endif // CONCURRENT_PAGING_SIMULATOR_HPP
@@ -0,0 +1,1751 @@
+/** @file DynamicPagingSimulator.cpp
+ * @brief A dynamic paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the dynamic paging simulator, everything but the
+ * inline fast paths of memory references.
+ */
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include "DynamicPagingSimulator.hpp"
+
+using namespace std;
+
+
+
+/** default constructor
+ * The default constructor for the paging simulator.  The page table
+ * starts out empty, matrix/processes A, B and C (and any others) are
+ * added to the simulation by addProcess() as the matrices are
+ * constructed.
+ *
+ * @param numFrames The number of physical frames in the frame pool.
+ * @param policy The page replacement policy to use, the simulator
+ *   takes ownership of it.  If NULL we default to LRU replacement.
+ */
+DynamicPagingSimulator::DynamicPagingSimulator(int numFrames, PageReplacementPolicy* policy)
+{
+  this->policy = NULL;
+  prefetcher = NULL;
+  pageSizeBytes = PAGE_SIZE_BYTES;
+  pageShift = __builtin_ctz(PAGE_SIZE_BYTES);
+  verbose = true;
+  displayPageCounts = false;
+  faultLogLimit = 0;
+  modelTranslation = false;
+  numNumaNodes = 1;
+  numaPlacement = FIRST_TOUCH_PLACEMENT;
+  loadControlWindow = 0;
+  highFaultRate = 1.0;
+  lowFaultRate = 0.0;
+  costs = DEFAULT_COST_MODEL;
+  displayClock = false;
+  configure(numFrames, policy);
+}
+
+
+/** paging simulator destructor
+ * Free up the page replacement policy, prefetcher and analyzers we own.
+ */
+DynamicPagingSimulator::~DynamicPagingSimulator()
+{
+  delete policy;
+  delete prefetcher;
+  for (ReferenceAnalyzer* analyzer : analyzers)
+  {
+    delete analyzer;
+  }
+}
+
+
+/** configure simulator
+ * Change the size of the frame pool and the page replacement policy
+ * used, and reset the simulation to start over with them.
+ *
+ * @param numFrames The number of physical frames in the frame pool.
+ * @param policy The page replacement policy to use, the simulator
+ *   takes ownership of it.  If NULL we default to LRU replacement.
+ */
+void DynamicPagingSimulator::configure(int numFrames, PageReplacementPolicy* policy)
+{
+  if (numFrames < 1)
+  {
+    cerr << "Error: DynamicPagingSimulator::configure() must have at least" << endl
+         << "   1 frame for the simulation, got: " << numFrames << endl;
+    exit(1);
+  }
+
+  if (policy == NULL)
+  {
+    policy = new LruPolicy();
+  }
+  if (policy != this->policy)
+  {
+    delete this->policy;
+  }
+
+  this->numFrames = numFrames;
+  this->policy = policy;
+  resetSimulation();
+}
+
+
+/** set page size
+ * Change the page size, and reset the simulation to start over with
+ * it.  Page sizes must be a power of 2, for example 4K, 16K or 2M.
+ *
+ * @param pageSizeBytes The new page size in bytes.
+ */
+void DynamicPagingSimulator::setPageSize(int pageSizeBytes)
+{
+  if (pageSizeBytes < int(sizeof(int)) or (pageSizeBytes & (pageSizeBytes - 1)) != 0)
+  {
+    cerr << "Error: DynamicPagingSimulator::setPageSize() page size must be" << endl
+         << "   a power of 2, got: " << pageSizeBytes << endl;
+    exit(1);
+  }
+
+  this->pageSizeBytes = pageSizeBytes;
+  pageShift = __builtin_ctz(pageSizeBytes);
+  if (radixPageTable.getLevels() > 0)
+  {
+    radixPageTable.configure(radixPageTable.getLevels(), pageShift);
+  }
+  resetSimulation();
+}
+
+
+/** get page size
+ * @returns int The page size in bytes.
+ */
+int DynamicPagingSimulator::getPageSize() const
+{
+  return pageSizeBytes;
+}
+
+
+/** set page table levels
+ * Model the multi-level page tables of a real machine with the
+ * indicated number of levels, e.g. 2 levels like 32 bit x86 or 4
+ * levels like x86-64, and reset the simulation to start over.  Every
+ * TLB miss, or every reference if there is no TLB, then walks the
+ * page table, so the depth of the walks and the memory used by the
+ * page tables can be reported.
+ *
+ * @param levels The number of levels of the page tables, or 0 to not
+ *   model them.
+ */
+void DynamicPagingSimulator::setPageTableLevels(int levels)
+{
+  if (levels == 0)
+  {
+    radixPageTable = RadixPageTable();
+  }
+  else
+  {
+    radixPageTable.configure(levels, pageShift);
+  }
+  modelTranslation = (tlb.getNumEntries() > 0) or (radixPageTable.getLevels() > 0);
+  resetSimulation();
+}
+
+
+/** set TLB
+ * Put a set associative TLB in front of the page table, and reset
+ * the simulation to start over.  The TLB is looked up on every
+ * reference, and the page table is only walked on a TLB miss.
+ *
+ * @param numEntries The number of entries of the TLB, or 0 for no TLB.
+ * @param ways The number of entries in each set of the TLB.
+ * @param asidTagging True if TLB entries are tagged with the process
+ *   id, false to flush the TLB whenever the process changes.
+ */
+void DynamicPagingSimulator::setTlb(int numEntries, int ways, bool asidTagging)
+{
+  if (numEntries == 0)
+  {
+    tlb = Tlb();
+  }
+  else
+  {
+    tlb.configure(numEntries, ways, asidTagging);
+  }
+  modelTranslation = (tlb.getNumEntries() > 0) or (radixPageTable.getLevels() > 0);
+  resetSimulation();
+}
+
+
+/** add analyzer
+ * Add an analyzer to be given every reference of the simulation, and
+ * reset the simulation to start over with it.  Its results are
+ * displayed after those of the simulator.
+ *
+ * @param analyzer The analyzer to add, the simulator takes ownership
+ *   of it.
+ */
+void DynamicPagingSimulator::addAnalyzer(ReferenceAnalyzer* analyzer)
+{
+  analyzers.push_back(analyzer);
+  resetSimulation();
+}
+
+
+/** set prefetcher
+ * Prefetch pages with the indicated prefetcher, instead of pure
+ * demand paging, and reset the simulation to start over with it.
+ * OPT replacement can not be used with a prefetcher, it expects every
+ * page loaded to be the next reference of its reference string.
+ *
+ * @param prefetcher The prefetcher to use, the simulator takes
+ *   ownership of it, or NULL for demand paging.
+ */
+void DynamicPagingSimulator::setPrefetcher(Prefetcher* prefetcher)
+{
+  if (prefetcher != this->prefetcher)
+  {
+    delete this->prefetcher;
+  }
+  this->prefetcher = prefetcher;
+  resetSimulation();
+}
+
+
+/** set NUMA nodes
+ * Split the frame pool evenly into NUMA nodes, and reset the
+ * simulation to start over with them.  With more nodes than frames
+ * some nodes have no memory.  Processes are given home nodes
+ * round robin as they are added, which can be changed with
+ * setHomeNode().
+ *
+ * @param numNodes The number of NUMA nodes, 1 for a uniform memory.
+ * @param placement Where the frames for new pages are allocated.
+ */
+void DynamicPagingSimulator::setNumaNodes(int numNodes, NumaPlacement placement)
+{
+  if (numNodes < 1)
+  {
+    cerr << "Error: DynamicPagingSimulator::setNumaNodes() must have at least" << endl
+         << "   1 NUMA node, got: " << numNodes << endl;
+    exit(1);
+  }
+
+  numNumaNodes = numNodes;
+  numaPlacement = placement;
+  resetSimulation();
+}
+
+
+/** set compressed tier
+ * Put a compressed tier of the indicated capacity between the frames
+ * and the disk, or take it away, and reset the simulation to start
+ * over with it.
+ *
+ * @param capacityBytes The most compressed bytes the tier holds, 0
+ *   for no tier.
+ */
+void DynamicPagingSimulator::setCompressedTier(long capacityBytes)
+{
+  if (capacityBytes < 0)
+  {
+    cerr << "Error: DynamicPagingSimulator::setCompressedTier() capacity can not" << endl
+         << "   be negative, got: " << capacityBytes << endl;
+    exit(1);
+  }
+
+  compressedTier.configure(capacityBytes);
+  resetSimulation();
+}
+
+
+/** set load control
+ * Turn load control on or off, and reset the simulation to start over
+ * with it.
+ *
+ * @param window The number of references the fault rate is measured
+ *   over, 0 to turn load control off.
+ * @param highFaultRate The fault rate above which a process is
+ *   suspended.
+ * @param lowFaultRate The fault rate below which a suspended process
+ *   is resumed.
+ */
+void DynamicPagingSimulator::setLoadControl(long window, double highFaultRate, double lowFaultRate)
+{
+  if (window < 0 or lowFaultRate < 0.0 or lowFaultRate > highFaultRate or highFaultRate > 1.0)
+  {
+    cerr << "Error: DynamicPagingSimulator::setLoadControl() invalid window: " << window << endl
+         << "   or fault rates, high: " << highFaultRate << " low: " << lowFaultRate << endl;
+    exit(1);
+  }
+
+  loadControlWindow = window;
+  this->highFaultRate = highFaultRate;
+  this->lowFaultRate = lowFaultRate;
+  resetSimulation();
+}
+
+
+/** set home node
+ * Change the NUMA node a process runs on.
+ *
+ * @param processId The id of the process.
+ * @param node The new home node of the process.
+ */
+void DynamicPagingSimulator::setHomeNode(int processId, int node)
+{
+  if (node < 0 or node >= numNumaNodes)
+  {
+    cerr << "Error: DynamicPagingSimulator::setHomeNode() unknown NUMA node: " << node << endl;
+    exit(1);
+  }
+  homeNode[processId] = node;
+}
+
+
+/** get frame node
+ * @param frame A physical frame.
+ *
+ * @returns int The NUMA node the frame is on.
+ */
+int DynamicPagingSimulator::getFrameNode(int frame) const
+{
+  return long(frame) * numNumaNodes / numFrames;
+}
+
+
+/** set verbose
+ * In verbose mode every page fault is displayed as it happens.  In
+ * quiet mode page faults are only counted, so that the simulation
+ * runs as fast as possible, and the counts and fault log are
+ * displayed at the end by displayResults().
+ *
+ * @param verbose True to display every page fault, false for quiet.
+ */
+void DynamicPagingSimulator::setVerbose(bool verbose)
+{
+  this->verbose = verbose;
+}
+
+
+/** set display page counts
+ * Whether displayResults() also shows the hit and fault counts of
+ * every page of every process, not just the totals of each process.
+ *
+ * @param displayPageCounts True to display the count of every page.
+ */
+void DynamicPagingSimulator::setDisplayPageCounts(bool displayPageCounts)
+{
+  this->displayPageCounts = displayPageCounts;
+}
+
+
+/** set fault log limit
+ * Keep a log of up to this many page faults, which is displayed at
+ * the end of the simulation.  The log is bounded so that it can not
+ * grow without limit on long simulations, faults past the limit are
+ * only counted.
+ *
+ * @param faultLogLimit The maximum number of faults to log, 0 to
+ *   not keep a fault log.
+ */
+void DynamicPagingSimulator::setFaultLogLimit(int faultLogLimit)
+{
+  this->faultLogLimit = faultLogLimit;
+  faultLog.reserve(faultLogLimit);
+}
+
+
+/** set cost model
+ * Set the time each event of the simulation takes on the simulated
+ * clock.  Takes effect from the next simulation.
+ *
+ * @param costs The costs of the events, none of them negative.
+ */
+void DynamicPagingSimulator::setCostModel(const CostModel& costs)
+{
+  if (costs.hitNanoseconds < 0.0 or costs.tlbMissNanoseconds < 0.0 or costs.minorFaultNanoseconds < 0.0 or
+      costs.diskNanoseconds < 0.0 or costs.tierNanoseconds < 0.0 or costs.diskIops < 0.0)
+  {
+    cerr << "Error: DynamicPagingSimulator::setCostModel() costs can not be negative" << endl;
+    exit(1);
+  }
+  this->costs = costs;
+}
+
+
+/** get cost model
+ * @returns CostModel The time each event of the simulation takes on
+ *   the simulated clock.
+ */
+CostModel DynamicPagingSimulator::getCostModel() const
+{
+  return costs;
+}
+
+
+/** set display clock
+ * @param displayClock True to display the cost model, the kinds of
+ *   faults, the effective access time and the simulated runtime with
+ *   the results.
+ */
+void DynamicPagingSimulator::setDisplayClock(bool displayClock)
+{
+  this->displayClock = displayClock;
+}
+
+
+/** display results
+ * When the simulation ends display final statistics and information
+ * about the paging behavior we just witnessed.  All of the output is
+ * gathered up and written in one go, so that the simulation is not
+ * slowed down by output while it runs.
+ */
+void DynamicPagingSimulator::displayResults()
+{
+  ostringstream out;
+
+  // display the fault log first, in the order the faults happened
+  if (not faultLog.empty())
+  {
+    out << "<DynamicPagingSimulator> fault log" << "\n";
+    for (const FaultLogEntry& fault : faultLog)
+    {
+      out << "    Matrix " << processNames[fault.processId];
+      if (fault.row != NO_REFERENCE)
+      {
+        out << " row: " << fault.row << " col: " << fault.col;
+      }
+      out << " new page: " << fault.pageNumber;
+      if (fault.victimProcessId != NO_PROCESS)
+      {
+        out << " replaced Matrix " << processNames[fault.victimProcessId] << " page: " << fault.victimPageNumber;
+      }
+      out << "\n";
+    }
+    if (faultLogDropped > 0)
+    {
+      out << "    ... " << faultLogDropped << " more page faults not logged" << "\n";
+    }
+  }
+
+  long totalHits = 0;
+  for (long hits : pageHitCounts)
+  {
+    totalHits += hits;
+  }
+
+  out << "<DynamicPagingSimulator> paging simulation ends" << "\n"
+      << "    Replacement policy: " << policy->getName() << " with " << numFrames << " frames" << "\n"
+      << "    Page size: " << pageSizeBytes << " bytes" << "\n"
+      << "    Total number of page hits seen: " << totalHits << "\n"
+      << "    Total number of page faults seen: " << pageFaultCount << "\n"
+      << "    Total number of dirty pages written back: " << writeBackCount << "\n";
+
+  // display the page table statistics, comparing the multi-level
+  // page tables with flat page tables for the same address spaces
+  if (radixPageTable.getLevels() > 0)
+  {
+    out << "    Page table levels: " << radixPageTable.getLevels() << "\n"
+        << "    Page table walks: " << radixPageTable.getNumWalks()
+        << " average walk depth: " << radixPageTable.getAverageWalkDepth() << "\n"
+        << "    Page table memory: " << radixPageTable.getTableBytes() << " bytes in "
+        << radixPageTable.getNumTables() << " tables" << "\n"
+        << "    Flat page table memory: " << long(pageTable.size()) * PAGE_TABLE_ENTRY_BYTES << " bytes" << "\n";
+  }
+
+  // display the TLB statistics, and what translation cost in total
+  if (tlb.getNumEntries() > 0)
+  {
+    out << "    TLB: " << tlb.getNumEntries() << " entries " << tlb.getWays() << " ways"
+        << (tlb.getAsidTagging() ? " with ASIDs" : " flushed on process switch") << "\n"
+        << "    TLB hits: " << tlb.getHits() << " misses: " << tlb.getMisses()
+        << " hit rate: " << tlb.getHitRate() << " flushes: " << tlb.getFlushes() << "\n";
+  }
+  if (prefetcher != NULL)
+  {
+    out << "    Prefetcher: " << prefetcher->getName() << "\n"
+        << "    Prefetches issued: " << prefetchesIssued << " useful: " << usefulPrefetches
+        << " wasted: " << wastedPrefetches << "\n";
+  }
+  if (not sharedPageTable.empty())
+  {
+    // every resident shared page saves a frame for each process after
+    // the first that still maps it
+    long sharedResident = 0;
+    long framesSaved = 0;
+    for (int index = 0; index < int(sharedPageTable.size()); index++)
+    {
+      if (sharedPageTable[index].present)
+      {
+        sharedResident++;
+        framesSaved += sharedPageSharers[index] - 1;
+      }
+    }
+    out << "    Shared pages: " << sharedPageTable.size() << " resident: " << sharedResident
+        << " frames saved: " << framesSaved << "\n"
+        << "    Copy on write faults: " << cowFaultCount << " pages copied: " << cowCopyCount << "\n";
+  }
+  if (numNumaNodes > 1)
+  {
+    long accesses = localAccesses + remoteAccesses;
+    out << "    NUMA nodes: " << numNumaNodes << " placement: "
+        << ((numaPlacement == FIRST_TOUCH_PLACEMENT) ? "first touch" : "interleave") << "\n"
+        << "    Local accesses: " << localAccesses << " remote accesses: " << remoteAccesses
+        << " remote ratio: " << ((accesses == 0) ? 0.0 : double(remoteAccesses) / accesses) << "\n"
+        << "    Memory access cycles: "
+        << localAccesses * LOCAL_NODE_ACCESS_CYCLES + remoteAccesses * REMOTE_NODE_ACCESS_CYCLES << "\n";
+  }
+  if (compressedTier.getCapacity() > 0)
+  {
+    compressedTier.displayResults(out);
+  }
+  if (loadControlWindow > 0)
+  {
+    out << "    Load control: window " << loadControlWindow << " references, suspend above fault rate " << highFaultRate
+        << " resume below " << lowFaultRate << "\n"
+        << "    Suspensions: " << suspensions << " resumptions: " << resumptions << "\n";
+  }
+  out << "    Total page I/O, pages read and written: " << diskAccesses << "\n";
+
+  if (modelTranslation)
+  {
+    long references = totalHits + pageFaultCount;
+    out << "    Translation cycles: " << translationCycles << " average per reference: "
+        << ((references == 0) ? 0.0 : double(translationCycles) / references) << "\n";
+  }
+
+  if (displayClock)
+  {
+    out << "    Cost model: hit " << costs.hitNanoseconds << " ns, TLB miss " << costs.tlbMissNanoseconds
+        << " ns, minor fault " << costs.minorFaultNanoseconds << " ns, disk " << costs.diskNanoseconds
+        << " ns, compressed tier " << costs.tierNanoseconds << " ns, disk IOPS ";
+    if (costs.diskIops > 0.0)
+    {
+      out << costs.diskIops << "\n";
+    }
+    else
+    {
+      out << "unlimited" << "\n";
+    }
+    out << "    Minor faults: " << minorFaultCount << " major faults: " << majorFaultCount
+        << " compressed tier faults: " << tierFaultCount << "\n"
+        << "    Disk accesses: " << diskAccesses << " queueing delay: " << diskQueueNanoseconds / 1.0e9 << " seconds"
+        << "\n"
+        << "    Effective access time: " << getEffectiveAccessNanoseconds() << " ns" << "\n"
+        << "    Simulated runtime: " << getSimulatedSeconds() << " seconds" << "\n";
+  }
+
+  // display the hits and faults of each process
+  for (int processId = 0; processId < int(processNames.size()); processId++)
+  {
+    long hits = 0;
+    long faults = 0;
+    int base = pageTableBase[processId];
+    for (int page = 0; page < pageTableSize[processId]; page++)
+    {
+      hits += pageHitCounts[base + page];
+      faults += pageFaultCounts[base + page];
+    }
+    out << "    Matrix " << processNames[processId] << " hits: " << hits << " faults: " << faults << "\n";
+
+    if (displayPageCounts)
+    {
+      for (int page = 0; page < pageTableSize[processId]; page++)
+      {
+        out << "        page " << page << " hits: " << pageHitCounts[base + page]
+            << " faults: " << pageFaultCounts[base + page] << "\n";
+      }
+    }
+  }
+
+  for (ReferenceAnalyzer* analyzer : analyzers)
+  {
+    analyzer->displayResults(out);
+  }
+
+  cout << out.str() << flush;
+}
+
+
+/** get page fault count
+ * @returns long The total number of page faults of the simulation so far.
+ */
+long DynamicPagingSimulator::getPageFaultCount() const
+{
+  return pageFaultCount;
+}
+
+
+/** get write back count
+ * @returns long The total number of dirty pages written back to disk
+ *   by the simulation so far.
+ */
+long DynamicPagingSimulator::getWriteBackCount() const
+{
+  return writeBackCount;
+}
+
+
+/** get number of references
+ * @returns long The total number of references of the simulation so far.
+ */
+long DynamicPagingSimulator::getNumReferences() const
+{
+  long references = pageFaultCount;
+  for (long hits : pageHitCounts)
+  {
+    references += hits;
+  }
+  return references;
+}
+
+
+/** get simulated seconds
+ * The time on the simulated clock, the time the simulation so far
+ * would take with the costs of the cost model.
+ *
+ * @returns double The simulated time in seconds.
+ */
+double DynamicPagingSimulator::getSimulatedSeconds() const
+{
+  return getClockNanoseconds() / 1.0e9;
+}
+
+
+/** get effective access time
+ * @returns double The average simulated time of a reference so far,
+ *   including the time it was held up by faults, in nanoseconds.
+ */
+double DynamicPagingSimulator::getEffectiveAccessNanoseconds() const
+{
+  return (referenceCount == 0) ? 0.0 : getClockNanoseconds() / referenceCount;
+}
+
+
+/** get clock
+ * @returns double The time on the simulated clock, in nanoseconds.
+ */
+double DynamicPagingSimulator::getClockNanoseconds() const
+{
+  return referenceCount * costs.hitNanoseconds + tlb.getMisses() * costs.tlbMissNanoseconds + stallNanoseconds;
+}
+
+
+/** reset simulation
+ * Reset the simulation for another run.  All processes are removed
+ * from the simulation, and so need to be added again, and all of the
+ * frames are free again.
+ */
+void DynamicPagingSimulator::resetSimulation()
+{
+  pageTable.clear();
+  pageTableBase.clear();
+  pageTableSize.clear();
+  processNames.clear();
+  processIds.clear();
+  pageHitCounts.clear();
+  pageFaultCounts.clear();
+  faultLog.clear();
+  faultLogDropped = 0;
+
+  sharedPageTable.clear();
+  sharedPageSharers.clear();
+  sharedBase.clear();
+  cowFaultCount = 0;
+  cowCopyCount = 0;
+
+  FrameTableEntry freeFrame = {NO_PROCESS, NO_PAGE, false};
+  frameTable.assign(numFrames, freeFrame);
+
+  // frames are handed out from the back, so push them in reverse
+  // to use the first frame of each node first
+  freeFrames.assign(numNumaNodes, vector<int>());
+  for (int frame = numFrames - 1; frame >= 0; frame--)
+  {
+    freeFrames[getFrameNode(frame)].push_back(frame);
+  }
+  homeNode.clear();
+  compressedTier.reset();
+  processContents.clear();
+  processContentBytes.clear();
+  pageBuffer.assign((compressedTier.getCapacity() > 0) ? pageSizeBytes : 0, 0);
+  localAccesses = 0;
+  remoteAccesses = 0;
+  windowReferences = 0;
+  windowFaults = 0;
+  windowProcessFaults.clear();
+  suspended.clear();
+  exited.clear();
+  suspendedQueue.clear();
+  suspensions = 0;
+  resumptions = 0;
+  policy->reset(numFrames);
+  radixPageTable.reset();
+  tlb.reset();
+  translationCycles = 0;
+  for (ReferenceAnalyzer* analyzer : analyzers)
+  {
+    analyzer->reset();
+  }
+  if (prefetcher != NULL)
+  {
+    prefetcher->reset();
+  }
+  prefetchesIssued = 0;
+  usefulPrefetches = 0;
+  wastedPrefetches = 0;
+
+  pageFaultCount = 0;
+  writeBackCount = 0;
+  referenceCount = 0;
+  stallNanoseconds = 0.0;
+  diskFreeNanoseconds = 0.0;
+  diskQueueNanoseconds = 0.0;
+  diskAccesses = 0;
+  minorFaultCount = 0;
+  majorFaultCount = 0;
+  tierFaultCount = 0;
+}
+
+
+/** add process
+ * Add a new matrix/process to the simulation.  A block of page table
+ * entries, one for each virtual page of the process, is appended to
+ * the flat page table and all of them are initially not present.
+ * Process ids are expected to be handed out in order starting from 0,
+ * as Matrix does, so that they can directly index our tables.
+ *
+ * @param processId The id of the new process, used for all memory
+ *   references made by the process.
+ * @param processName The name of the process, e.g. A, B or C.
+ * @param numPages The number of virtual pages in the address space of
+ *   the process.
+ */
+void DynamicPagingSimulator::addProcess(int processId, const string& processName, int numPages)
+{
+  if (processId != int(pageTableBase.size()))
+  {
+    cerr << "Error: DynamicPagingSimulator::addProcess() process ids must" << endl
+         << "   be added in order, expected " << pageTableBase.size() << " but got " << processId << endl;
+    exit(1);
+  }
+
+  PageTableEntry notPresent = {false, NO_FRAME, false, false, false, false};
+  pageTableBase.push_back(pageTable.size());
+  pageTableSize.push_back(numPages);
+  sharedBase.push_back(NO_SHARED_SEGMENT);
+  homeNode.push_back(processId % numNumaNodes);
+  processContents.push_back(NULL);
+  processContentBytes.push_back(0);
+  windowProcessFaults.push_back(0);
+  suspended.push_back(false);
+  exited.push_back(false);
+  pageTable.resize(pageTable.size() + numPages, notPresent);
+  pageHitCounts.resize(pageTable.size(), 0);
+  pageFaultCounts.resize(pageTable.size(), 0);
+  if (radixPageTable.getLevels() > 0)
+  {
+    radixPageTable.addProcess(processId);
+  }
+
+  for (ReferenceAnalyzer* analyzer : analyzers)
+  {
+    analyzer->addProcess(processId, processName, numPages);
+  }
+
+  processNames.push_back(processName);
+  processIds[processName] = processId;
+}
+
+
+/** set process contents
+ * Give the real contents of the address space of a process, which
+ * are compressed when its pages go to the compressed tier.  The
+ * contents must stay valid until the simulation is reset.  The pages
+ * holding the contents are backed by them, so like pages that went to
+ * swap they are read from disk on every fault, the first included,
+ * instead of being zero filled.
+ *
+ * @param processId The id of the process.
+ * @param contents The contents of the address space.
+ * @param numBytes The size of the contents in bytes.
+ */
+void DynamicPagingSimulator::setProcessContents(int processId, const void* contents, long numBytes)
+{
+  processContents[processId] = static_cast<const unsigned char*>(contents);
+  processContentBytes[processId] = numBytes;
+
+  long numBackedPages = min(long(pageTableSize[processId]), (numBytes + pageSizeBytes - 1) / pageSizeBytes);
+  for (int page = 0; page < numBackedPages; page++)
+  {
+    pageTable[pageTableBase[processId] + page].swapped = true;
+  }
+}
+
+
+/** is suspended
+ * @param processId The id of a process.
+ *
+ * @returns bool True if load control has suspended the process.
+ */
+bool DynamicPagingSimulator::isSuspended(int processId) const
+{
+  return suspended[processId];
+}
+
+
+/** suspend process
+ * Suspend a process, swapping out all of its pages, so its frames are
+ * free for the other processes.  Shared pages stay for the processes
+ * sharing them.
+ *
+ * @param processId The id of the process to suspend.
+ */
+void DynamicPagingSimulator::suspendProcess(int processId)
+{
+  if (suspended[processId] or exited[processId])
+  {
+    return;
+  }
+
+  suspended[processId] = true;
+  suspendedQueue.push_back(processId);
+  suspensions++;
+  releaseFrames(processId);
+}
+
+
+/** resume process
+ * Let a suspended process run again, its pages fault back in as it
+ * references them.
+ *
+ * @param processId The id of the process to resume.
+ */
+void DynamicPagingSimulator::resumeProcess(int processId)
+{
+  if (not suspended[processId])
+  {
+    return;
+  }
+
+  suspended[processId] = false;
+  suspendedQueue.erase(find(suspendedQueue.begin(), suspendedQueue.end(), processId));
+  resumptions++;
+}
+
+
+/** exit process
+ * A process has finished, so its frames are free, and load control no
+ * longer suspends or resumes it.
+ *
+ * @param processId The id of the process that finished.
+ */
+void DynamicPagingSimulator::exitProcess(int processId)
+{
+  if (suspended[processId])
+  {
+    suspended[processId] = false;
+    suspendedQueue.erase(find(suspendedQueue.begin(), suspendedQueue.end(), processId));
+  }
+  exited[processId] = true;
+  releaseFrames(processId);
+}
+
+
+/** add shared process
+ * Add a new matrix/process to the simulation that shares the pages
+ * of an existing process copy on write, as a process forked from it
+ * would.  The first time the source is shared its pages, and the
+ * frames holding them, move to a new shared segment, which the source
+ * and all of the processes sharing it then map.  A later process
+ * shared from the same source maps the same segment, so it sees the
+ * pages as they were when the source was first shared, except that
+ * pages the source has since written are its own from the start.
+ * OPT can not be used, its reference string has no way to say a page
+ * is shared, so callers must not share pages when the policy is OPT.
+ *
+ * @param processId The id of the new process.
+ * @param processName The name of the process.
+ * @param sourceProcessId The process whose pages are shared.
+ */
+void DynamicPagingSimulator::addSharedProcess(int processId, const string& processName, int sourceProcessId)
+{
+  if (sourceProcessId < 0 or sourceProcessId >= int(pageTableBase.size()))
+  {
+    cerr << "Error: DynamicPagingSimulator::addSharedProcess() can not share" << endl
+         << "   the pages of unknown process " << sourceProcessId << endl;
+    exit(1);
+  }
+
+  int sourceBase = pageTableBase[sourceProcessId];
+  int numPages = pageTableSize[sourceProcessId];
+  if (sharedBase[sourceProcessId] == NO_SHARED_SEGMENT)
+  {
+    sharedBase[sourceProcessId] = sharedPageTable.size();
+    for (int page = 0; page < numPages; page++)
+    {
+      PageTableEntry& entry = pageTable[sourceBase + page];
+      sharedPageTable.push_back(entry);
+      sharedPageSharers.push_back(1);
+      if (entry.present)
+      {
+        frameTable[entry.frame].shared = true;
+      }
+      entry.present = false;
+      entry.frame = NO_FRAME;
+      entry.prefetched = false;
+      entry.dirty = false;
+      entry.shared = true;
+    }
+  }
+
+  addProcess(processId, processName, numPages);
+  int base = pageTableBase[processId];
+  sharedBase[processId] = sharedBase[sourceProcessId];
+  for (int page = 0; page < numPages; page++)
+  {
+    if (pageTable[sourceBase + page].shared)
+    {
+      pageTable[base + page].shared = true;
+      sharedPageSharers[sharedBase[processId] + page]++;
+    }
+  }
+}
+
+
+/** get process id
+ * Look up the process id of a named matrix/process.  A name we have
+ * not seen before is added as a new process with a full matrix sized
+ * address space, the same as the old map based page table did when
+ * it was asked about a new name.
+ *
+ * @param processName The name of the matrix/process to look up.
+ *
+ * @returns int The id of the named process.
+ */
+int DynamicPagingSimulator::getProcessId(const string& processName)
+{
+  map<string, int>::iterator it = processIds.find(processName);
+  if (it != processIds.end())
+  {
+    return it->second;
+  }
+
+  int processId = pageTableBase.size();
+  addProcess(processId, processName, translateReferenceToPage(MATRIX_SIZE - 1, MATRIX_SIZE - 1) + 1);
+  return processId;
+}
+
+
+/** check for page fault
+ * Check if a page fault has occurred for the indicated page number
+ * memory reference.
+ *
+ * @param processId The id of the matrix/process making the page number reference.
+ * @param pageNumber The page number being referenced.
+ *
+ * @returns bool True if a page fault needs to occure (the page number referenced
+ *   is not loaded), or false if there is no page fault.
+ */
+bool DynamicPagingSimulator::pageFault(int processId, int pageNumber)
+{
+  return not residentEntry(processId, pageNumber).present;
+}
+
+
+/** check for page fault
+ * Compatibility version of pageFault() that identifies the
+ * matrix/process by name.
+ *
+ * @param matrixName The name of the matrix/process making the page number reference.
+ * @param pageNumber The page number being referenced.
+ *
+ * @returns bool True if a page fault needs to occure (the page number referenced
+ *   is not loaded), or false if there is no page fault.
+ */
+bool DynamicPagingSimulator::pageFault(const string& matrixName, int pageNumber)
+{
+  return pageFault(getProcessId(matrixName), pageNumber);
+}
+
+
+/** check memory referece
+ * For the DynamicPagingSimulator class, called before all memory 
+ * references occur so that we can simulate maintining a page table,
+ * and dynamically loading needed pages before they are referenced when
+ * needed.  This is a compatibility version that identifies the
+ * matrix/process by name, it is much slower than the process id
+ * version, which is what Matrix uses.
+ *
+ * @param matrixName The name of the matrix (process) requesting a
+ *   memory reference.
+ * @param row, col The row and column being requested.  Think of this as 
+ *   the virtual address space of the matrix/process.  We translate this 
+ *   to a virtual page and offset for this simulation.
+ */
+void DynamicPagingSimulator::checkMemoryReference(const string& matrixName, int row, int col)
+{
+  checkMemoryReference(getProcessId(matrixName), row, col);
+}
+
+
+/** reference batch
+ * Simulate a batch of references, for example the references to the
+ * elements of a row or column of a matrix.  Consecutive references
+ * by a process to the same page are simulated as a run.  The first
+ * reference of a run is simulated as usual, and if it leaves the page
+ * present the rest of the run are hits, which are counted all at
+ * once.  Unless nothing needs to see each reference, that is the TLB,
+ * the NUMA nodes, load control and the analyzers, every reference is
+ * simulated in turn.
+ *
+ * @param references The references to simulate, in order.
+ * @param numReferences The number of references.
+ * @param isWrite True if the references are writes.
+ */
+void DynamicPagingSimulator::referenceBatch(const PageReference* references, long numReferences, bool isWrite)
+{
+  if (modelTranslation or numNumaNodes > 1 or loadControlWindow > 0 or not analyzers.empty())
+  {
+    for (long next = 0; next < numReferences; next++)
+    {
+      reference(references[next].processId, references[next].pageNumber, NO_REFERENCE, NO_REFERENCE, isWrite);
+    }
+    return;
+  }
+
+  long next = 0;
+  while (next < numReferences)
+  {
+    int processId = references[next].processId;
+    int pageNumber = references[next].pageNumber;
+    long runEnd = next + 1;
+    while (runEnd < numReferences and references[runEnd].pageNumber == pageNumber and
+           references[runEnd].processId == processId)
+    {
+      runEnd++;
+    }
+
+    reference(processId, pageNumber, NO_REFERENCE, NO_REFERENCE, isWrite);
+    next++;
+
+    // a shared page is not present in the page table of the process,
+    // so its references are simulated one at a time
+    int index = pageTableBase[processId] + pageNumber;
+    const PageTableEntry& entry = pageTable[index];
+    if (entry.present and runEnd > next)
+    {
+      referenceCount += runEnd - next;
+      pageHitCounts[index] += runEnd - next;
+      policy->pageRereferenced(entry.frame, runEnd - next);
+      next = runEnd;
+    }
+    for (; next < runEnd; next++)
+    {
+      reference(processId, pageNumber, NO_REFERENCE, NO_REFERENCE, isWrite);
+    }
+  }
+}
+
+
+/** reference shared
+ * A reference to a page the process still shares with other
+ * processes.  A read is a hit or a fault on the shared page.  A write
+ * is a copy on write fault, after which the process has its own copy
+ * of the page.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ * @param row, col The row and column being requested, or NO_REFERENCE.
+ * @param isWrite True if the reference is a write.
+ *
+ * @returns bool True if the reference was a page fault.
+ */
+bool DynamicPagingSimulator::referenceShared(int processId, int pageNumber, int row, int col, bool isWrite)
+{
+  PageTableEntry& shared = sharedPageTable[sharedBase[processId] + pageNumber];
+  bool pageFault = not shared.present;
+  if (shared.present)
+  {
+    pageHitCounts[pageTableBase[processId] + pageNumber]++;
+    policy->pageReferenced(shared.frame);
+    if (shared.prefetched)
+    {
+      prefetchHit(processId, pageNumber);
+    }
+  }
+
+  if (isWrite)
+  {
+    copyOnWrite(processId, pageNumber, row, col);
+  }
+  else if (pageFault)
+  {
+    handlePageFault(processId, pageNumber, row, col);
+  }
+  return pageFault;
+}
+
+
+/** copy on write
+ * The process is writing a page it shares, so it stops sharing it.
+ * The last process sharing a page takes the shared page over without
+ * copying it, otherwise the process gets a frame of its own and the
+ * page is copied into it, the frame of the shared page being pinned
+ * so it is not replaced.  A shared page that is not resident is
+ * simply faulted in to a frame of its own.  With a single frame there
+ * is nowhere to copy the page to, so the shared page is replaced and
+ * then faulted in to the frame as the page of the process.
+ *
+ * @param processId The id of the process writing the page.
+ * @param pageNumber The page being written.
+ * @param row, col The row and column being written, or NO_REFERENCE.
+ */
+void DynamicPagingSimulator::copyOnWrite(int processId, int pageNumber, int row, int col)
+{
+  int sharedIndex = sharedBase[processId] + pageNumber;
+  PageTableEntry& shared = sharedPageTable[sharedIndex];
+  PageTableEntry& entry = pageTable[pageTableBase[processId] + pageNumber];
+  bool present = shared.present;
+  cowFaultCount++;
+  entry.shared = false;
+  entry.swapped = shared.swapped;
+  sharedPageSharers[sharedIndex]--;
+
+  if (sharedPageSharers[sharedIndex] == 0)
+  {
+    entry.present = shared.present;
+    entry.frame = shared.frame;
+    entry.dirty = shared.dirty;
+    if (shared.present)
+    {
+      frameTable[shared.frame].processId = processId;
+      frameTable[shared.frame].shared = false;
+    }
+    shared.present = false;
+    shared.frame = NO_FRAME;
+    shared.prefetched = false;
+    shared.dirty = false;
+  }
+  else if (present and numFrames == 1)
+  {
+    int frame = policy->selectVictim(NO_PINNED_FRAME);
+    evictFrame(frame);
+    frameTable[frame].processId = NO_PROCESS;
+    frameTable[frame].pageNumber = NO_PAGE;
+    freeFrames[getFrameNode(frame)].push_back(frame);
+    entry.swapped = shared.swapped;
+  }
+  else if (present)
+  {
+    int frame = allocateFrame(processId, pageNumber, shared.frame);
+    evictFrame(frame);
+    mapPage(processId, pageNumber, frame);
+    cowCopyCount++;
+    stallNanoseconds += costs.minorFaultNanoseconds;
+  }
+
+  if (not entry.present)
+  {
+    handlePageFault(processId, pageNumber, row, col);
+  }
+}
+
+
+/** resident entry
+ * The entry that says where the page of the process is resident, the
+ * entry of the shared page if the process still shares it.
+ *
+ * @param processId The id of the process.
+ * @param pageNumber The virtual page of the process.
+ *
+ * @returns PageTableEntry& The entry of the page.
+ */
+PageTableEntry& DynamicPagingSimulator::residentEntry(int processId, int pageNumber)
+{
+  PageTableEntry& entry = pageTable[pageTableBase[processId] + pageNumber];
+  if (entry.shared)
+  {
+    return sharedPageTable[sharedBase[processId] + pageNumber];
+  }
+  return entry;
+}
+
+
+/** translate
+ * Translate the reference as the hardware would, looking it up in the
+ * TLB first, and walking the page table on a TLB miss, and charge the
+ * cycles it takes.  Without a modeled multi-level page table a walk
+ * is a single access to the flat page table.  Kept out of line so that
+ * the reference fast path stays small when translation is not modeled.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ */
+void DynamicPagingSimulator::translate(int processId, int pageNumber)
+{
+  if (tlb.getNumEntries() > 0)
+  {
+    translationCycles += TLB_LOOKUP_CYCLES;
+    if (tlb.lookup(processId, pageNumber))
+    {
+      return;
+    }
+  }
+
+  int depth = 1;
+  if (radixPageTable.getLevels() > 0)
+  {
+    depth = radixPageTable.walk(processId, pageNumber);
+  }
+  translationCycles += long(depth) * PAGE_WALK_ACCESS_CYCLES;
+}
+
+
+/** analyze reference
+ * Give the reference to each of the analyzers.  Kept out of line so
+ * that the reference fast path stays small when nothing is analyzed.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ * @param pageFault True if the reference was a page fault.
+ */
+void DynamicPagingSimulator::analyzeReference(int processId, int pageNumber, bool pageFault)
+{
+  for (ReferenceAnalyzer* analyzer : analyzers)
+  {
+    analyzer->reference(processId, pageNumber, pageFault);
+  }
+}
+
+
+/** NUMA access
+ * Count the reference as a local or remote memory access, from the
+ * home node of the process to the node of the frame holding the page.
+ * Kept out of line so that the reference fast path stays small when
+ * there is only one node.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced, now resident.
+ */
+void DynamicPagingSimulator::numaAccess(int processId, int pageNumber)
+{
+  if (getFrameNode(residentEntry(processId, pageNumber).frame) == homeNode[processId])
+  {
+    localAccesses++;
+  }
+  else
+  {
+    remoteAccesses++;
+  }
+}
+
+
+/** monitor load
+ * Count the reference in the fault rate window of load control, and at
+ * the end of each window suspend a process if the system is thrashing,
+ * or resume one if there is room for it again.  The process faulting
+ * most in the window is the one suspended, and at least one process
+ * is always left running.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageFault True if the reference was a page fault.
+ */
+void DynamicPagingSimulator::monitorLoad(int processId, bool pageFault)
+{
+  windowReferences++;
+  if (pageFault)
+  {
+    windowFaults++;
+    windowProcessFaults[processId]++;
+  }
+  if (windowReferences < loadControlWindow)
+  {
+    return;
+  }
+
+  double faultRate = double(windowFaults) / windowReferences;
+  if (faultRate > highFaultRate)
+  {
+    int victim = NO_PROCESS;
+    int numRunning = 0;
+    for (int process = 0; process < int(suspended.size()); process++)
+    {
+      if (suspended[process] or exited[process])
+      {
+        continue;
+      }
+      numRunning++;
+      if (victim == NO_PROCESS or windowProcessFaults[process] > windowProcessFaults[victim])
+      {
+        victim = process;
+      }
+    }
+    if (numRunning > 1)
+    {
+      suspendProcess(victim);
+    }
+  }
+  else if (faultRate < lowFaultRate and not suspendedQueue.empty())
+  {
+    resumeProcess(suspendedQueue.front());
+  }
+
+  windowReferences = 0;
+  windowFaults = 0;
+  windowProcessFaults.assign(windowProcessFaults.size(), 0);
+}
+
+
+/** handle page fault
+ * Called from checkMemoryReference() when the referenced page is not
+ * present.  The page is loaded into a free frame if there is one,
+ * otherwise the replacement policy selects a victim frame, and the
+ * page in it is replaced by the referenced page.
+ *
+ * @param processId The id of the matrix (process) that faulted.
+ * @param pageNumber The page number that was referenced.
+ * @param row, col The row and column reference that caused the fault,
+ *   or NO_REFERENCE if it was a reference to a page.
+ */
+void DynamicPagingSimulator::handlePageFault(int processId, int pageNumber, int row, int col)
+{
+  int frame = allocateFrame(processId, pageNumber);
+
+  FrameTableEntry& frameEntry = frameTable[frame];
+  if (verbose)
+  {
+    cout << "Page Fault occurred for Matrix " << processNames[processId];
+    if (row != NO_REFERENCE)
+    {
+      cout << " reference to row: " << row << " col: " << col << "\n";
+    }
+    else
+    {
+      cout << " reference to page: " << pageNumber << "\n";
+    }
+    cout << "     old page: " << frameEntry.pageNumber;
+    if (frameEntry.processId != NO_PROCESS and frameEntry.processId != processId)
+    {
+      cout << " (Matrix " << processNames[frameEntry.processId] << ")";
+    }
+    cout << "\n";
+    cout << "     new page: " << pageNumber << "\n";
+  }
+
+  if (int(faultLog.size()) < faultLogLimit)
+  {
+    FaultLogEntry fault = {processId, row, col, pageNumber, frameEntry.processId, frameEntry.pageNumber};
+    faultLog.push_back(fault);
+  }
+  else if (faultLogLimit > 0)
+  {
+    faultLogDropped++;
+  }
+
+  // perform the page replacement, the victim page is no longer present
+  bool swapped = residentEntry(processId, pageNumber).swapped;
+  evictFrame(frame);
+  chargePageLoad(swapped, mapPage(processId, pageNumber, frame), true);
+
+  // keep track of the count of page faults that occur
+  pageFaultCount++;
+  pageFaultCounts[pageTableBase[processId] + pageNumber]++;
+
+  if (prefetcher != NULL)
+  {
+    prefetch(processId, pageNumber);
+  }
+}
+
+
+/** prefetch hit
+ * The first reference to a page that was prefetched, a page fault the
+ * prefetch saved.  It triggers the prefetcher as a fault would have,
+ * so prefetching keeps ahead of a stream of references.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The prefetched page being referenced.
+ */
+void DynamicPagingSimulator::prefetchHit(int processId, int pageNumber)
+{
+  residentEntry(processId, pageNumber).prefetched = false;
+  usefulPrefetches++;
+  prefetch(processId, pageNumber);
+}
+
+
+/** prefetch
+ * Trigger the prefetcher, and load the pages it asks for that are in
+ * the address space of the process and not already present.  The
+ * replacement policy is told the pages were prefetched, so they are
+ * the first pages it replaces until they are referenced, and a
+ * prefetch can not push out the pages being worked on.  The frame of
+ * the page that triggered the prefetch is pinned while they are
+ * loaded, so a prefetch never replaces it, though the pages of one
+ * prefetch may replace each other.  At most one in
+ * PREFETCH_FRAME_FRACTION frames hold prefetched pages that were not
+ * referenced yet, once that many are resident no more are loaded, so
+ * with fewer frames than that nothing is prefetched.
+ *
+ * @param processId The id of the process that missed.
+ * @param pageNumber The page that missed, which is resident.
+ */
+void DynamicPagingSimulator::prefetch(int processId, int pageNumber)
+{
+  prefetchPages.clear();
+  prefetcher->trigger(processId, pageNumber, prefetchPages);
+
+  int pinnedFrame = residentEntry(processId, pageNumber).frame;
+  long maxInFlight = numFrames / PREFETCH_FRAME_FRACTION;
+  for (int page : prefetchPages)
+  {
+    if (prefetchesIssued - usefulPrefetches - wastedPrefetches >= maxInFlight)
+    {
+      break;
+    }
+    if (page < 0 or page >= pageTableSize[processId] or residentEntry(processId, page).present)
+    {
+      continue;
+    }
+
+    int frame = allocateFrame(processId, page, pinnedFrame);
+    bool swapped = residentEntry(processId, page).swapped;
+    evictFrame(frame);
+    chargePageLoad(swapped, mapPage(processId, page, frame, true), false);
+    prefetchesIssued++;
+  }
+}
+
+
+/** allocate frame
+ * Find a frame to load a page into, a free frame if there are any
+ * left, otherwise the victim chosen by the replacement policy, whose
+ * page is still mapped.  A free frame is taken from the NUMA node the
+ * placement policy picks for the page if it has one, otherwise from
+ * the nodes after it in turn.
+ *
+ * @param processId The id of the process the page is loaded for.
+ * @param pageNumber The page being loaded.
+ * @param pinnedFrame A frame whose page must not be replaced, or
+ *   NO_PINNED_FRAME.
+ *
+ * @returns int The frame to load the page into.
+ */
+int DynamicPagingSimulator::allocateFrame(int processId, int pageNumber, int pinnedFrame)
+{
+  int preferredNode = 0;
+  if (numNumaNodes > 1)
+  {
+    preferredNode = (numaPlacement == INTERLEAVE_PLACEMENT) ? pageNumber % numNumaNodes : homeNode[processId];
+  }
+
+  for (int step = 0; step < numNumaNodes; step++)
+  {
+    vector<int>& nodeFreeFrames = freeFrames[(preferredNode + step) % numNumaNodes];
+    if (not nodeFreeFrames.empty())
+    {
+      int frame = nodeFreeFrames.back();
+      nodeFreeFrames.pop_back();
+      return frame;
+    }
+  }
+  return policy->selectVictim(pinnedFrame);
+}
+
+
+/** evict frame
+ * The page in the frame, if any, is being replaced, so it is no
+ * longer present.  A dirty page is written back, unless it goes to
+ * the compressed tier, and a prefetched page that was never
+ * referenced was a wasted prefetch.
+ *
+ * @param frame The frame being replaced.
+ */
+void DynamicPagingSimulator::evictFrame(int frame)
+{
+  FrameTableEntry& frameEntry = frameTable[frame];
+  if (frameEntry.processId == NO_PROCESS)
+  {
+    return;
+  }
+
+  PageTableEntry& victim = frameEntry.shared
+                             ? sharedPageTable[sharedBase[frameEntry.processId] + frameEntry.pageNumber]
+                             : pageTable[pageTableBase[frameEntry.processId] + frameEntry.pageNumber];
+  if (victim.prefetched)
+  {
+    wastedPrefetches++;
+  }
+  if (compressedTier.getCapacity() > 0)
+  {
+    readPage(frameEntry.processId, frameEntry.pageNumber);
+    writeBack(compressedTier.store(tierKey(frameEntry.processId, frameEntry.pageNumber, frameEntry.shared),
+                                   pageBuffer.data(), pageSizeBytes, victim.dirty));
+  }
+  else if (victim.dirty)
+  {
+    writeBack(1);
+  }
+
+  // a dirty page is written back, or kept dirty by the compressed
+  // tier until it is written back, while a clean page without
+  // contents that never went to disk is zero filled again
+  if (victim.dirty)
+  {
+    victim.swapped = true;
+  }
+  victim.present = false;
+  victim.frame = NO_FRAME;
+  victim.prefetched = false;
+  victim.dirty = false;
+  unmapTranslation(frameEntry.processId, frameEntry.pageNumber, frameEntry.shared);
+}
+
+
+/** map page
+ * Load a page into a frame, that is free or has just been evicted.
+ *
+ * @param processId The id of the process whose page is loaded.
+ * @param pageNumber The page being loaded.
+ * @param frame The frame to load the page into.
+ * @param prefetched True if the page is prefetched, rather than
+ *   loaded for the reference that faulted.
+ *
+ * @returns bool True if the page was decompressed from the compressed
+ *   tier.
+ */
+bool DynamicPagingSimulator::mapPage(int processId, int pageNumber, int frame, bool prefetched)
+{
+  PageTableEntry& entry = residentEntry(processId, pageNumber);
+  entry.present = true;
+  entry.frame = frame;
+  entry.prefetched = prefetched;
+  entry.dirty = false;
+  frameTable[frame].processId = processId;
+  frameTable[frame].pageNumber = pageNumber;
+  frameTable[frame].shared = pageTable[pageTableBase[processId] + pageNumber].shared;
+
+  // a page in the compressed tier is decompressed instead of read
+  // from disk, and is still dirty if it never got to disk
+  bool dirty;
+  bool fromTier = compressedTier.getCapacity() > 0 and
+                  compressedTier.load(tierKey(processId, pageNumber, frameTable[frame].shared), pageBuffer.data(),
+                                      pageSizeBytes, dirty);
+  if (fromTier)
+  {
+    entry.dirty = dirty;
+  }
+  if (prefetched)
+  {
+    policy->pagePrefetched(frame);
+  }
+  else
+  {
+    policy->pageLoaded(frame);
+  }
+  if (radixPageTable.getLevels() > 0)
+  {
+    radixPageTable.map(processId, pageNumber);
+  }
+  return fromTier;
+}
+
+
+/** charge page load
+ * Advance the simulated clock by the time loading a page takes.  A
+ * page from the compressed tier is decompressed, a page that went to
+ * swap or has contents is read from disk, and any other page is zero
+ * filled.  The references wait for a synchronous load, a fault, but
+ * not for the disk read of a prefetch, which only occupies the disk.
+ *
+ * @param swapped True if the page has to be read from disk, as it
+ *   went to swap or is backed by the contents of its process.
+ * @param fromTier True if the page was decompressed from the
+ *   compressed tier.
+ * @param synchronous True if the load is a page fault.
+ */
+void DynamicPagingSimulator::chargePageLoad(bool swapped, bool fromTier, bool synchronous)
+{
+  if (fromTier)
+  {
+    stallNanoseconds += costs.tierNanoseconds;
+  }
+  else if (swapped)
+  {
+    diskAccess(1, synchronous);
+  }
+  else if (synchronous)
+  {
+    stallNanoseconds += costs.minorFaultNanoseconds;
+  }
+
+  if (not synchronous)
+  {
+    return;
+  }
+  if (fromTier)
+  {
+    tierFaultCount++;
+  }
+  else if (swapped)
+  {
+    majorFaultCount++;
+  }
+  else
+  {
+    minorFaultCount++;
+  }
+}
+
+
+/** write back
+ * Write dirty pages back to disk.  The frame they are in is not
+ * reused until they are written, so the references wait for them.
+ *
+ * @param numPages The number of pages written back.
+ */
+void DynamicPagingSimulator::writeBack(long numPages)
+{
+  writeBackCount += numPages;
+  diskAccess(numPages, true);
+}
+
+
+/** disk access
+ * Queue pages to be read or written on the simulated disk.  The disk
+ * starts a page at most once every 1 / IOPS seconds, a page is done
+ * the disk latency after it starts.  Without an IOPS limit pages
+ * never queue.
+ *
+ * @param numPages The number of pages read or written.
+ * @param synchronous True if the references wait until the pages are
+ *   done, false if they go on while the disk works.
+ */
+void DynamicPagingSimulator::diskAccess(long numPages, bool synchronous)
+{
+  double interval = (costs.diskIops > 0.0) ? 1.0e9 / costs.diskIops : 0.0;
+  for (long page = 0; page < numPages; page++)
+  {
+    double issued = getClockNanoseconds();
+    double start = max(issued, diskFreeNanoseconds);
+    diskFreeNanoseconds = start + interval;
+    diskQueueNanoseconds += start - issued;
+    diskAccesses++;
+    if (synchronous)
+    {
+      stallNanoseconds += start - issued + costs.diskNanoseconds;
+    }
+  }
+}
+
+
+/** unmap translation
+ * A page is no longer resident, so remove its translation from the
+ * modeled page tables and the TLB.  A shared page is removed from
+ * every process that still maps it.
+ *
+ * @param processId The id of the process the page was loaded for.
+ * @param pageNumber The page that is no longer resident.
+ * @param shared True if the page is a shared page.
+ */
+void DynamicPagingSimulator::unmapTranslation(int processId, int pageNumber, bool shared)
+{
+  if (radixPageTable.getLevels() == 0 and tlb.getNumEntries() == 0)
+  {
+    return;
+  }
+
+  for (int mapper = 0; mapper < int(pageTableBase.size()); mapper++)
+  {
+    bool maps = (mapper == processId);
+    if (shared)
+    {
+      maps = sharedBase[mapper] == sharedBase[processId] and pageTable[pageTableBase[mapper] + pageNumber].shared;
+    }
+    if (not maps)
+    {
+      continue;
+    }
+
+    if (radixPageTable.getLevels() > 0)
+    {
+      radixPageTable.unmap(mapper, pageNumber);
+    }
+    if (tlb.getNumEntries() > 0)
+    {
+      tlb.invalidate(mapper, pageNumber);
+    }
+  }
+}
+
+
+/** tier key
+ * The key a page is known by in the compressed tier, the index of its
+ * page table entry, or of its shared page for a shared page.
+ *
+ * @param processId The id of the process.
+ * @param pageNumber The virtual page of the process.
+ * @param shared True if the page is a shared page.
+ *
+ * @returns long The key of the page.
+ */
+long DynamicPagingSimulator::tierKey(int processId, int pageNumber, bool shared) const
+{
+  if (shared)
+  {
+    return -1L - (sharedBase[processId] + pageNumber);
+  }
+  return pageTableBase[processId] + pageNumber;
+}
+
+
+/** read page
+ * Copy the contents of a page of a process into the page buffer.  The
+ * part of the page past the end of the contents, and all of a page of
+ * a process without contents, is zero filled.
+ *
+ * @param processId The id of the process.
+ * @param pageNumber The virtual page to read.
+ */
+void DynamicPagingSimulator::readPage(int processId, int pageNumber)
+{
+  long start = long(pageNumber) * pageSizeBytes;
+  long numBytes = 0;
+  if (processContents[processId] != NULL and start < processContentBytes[processId])
+  {
+    numBytes = min(long(pageSizeBytes), processContentBytes[processId] - start);
+    memcpy(pageBuffer.data(), processContents[processId] + start, numBytes);
+  }
+  memset(pageBuffer.data() + numBytes, 0, pageSizeBytes - numBytes);
+}
+
+
+/** release frames
+ * Swap out all of the pages of a process, except for shared pages,
+ * and free their frames.
+ *
+ * @param processId The id of the process.
+ */
+void DynamicPagingSimulator::releaseFrames(int processId)
+{
+  for (int frame = 0; frame < numFrames; frame++)
+  {
+    FrameTableEntry& frameEntry = frameTable[frame];
+    if (frameEntry.processId != processId or frameEntry.shared)
+    {
+      continue;
+    }
+
+    evictFrame(frame);
+    policy->pageFreed(frame);
+    frameEntry.processId = NO_PROCESS;
+    frameEntry.pageNumber = NO_PAGE;
+    freeFrames[getFrameNode(frame)].push_back(frame);
+  }
+}
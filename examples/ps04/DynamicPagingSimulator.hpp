@@ -0,0 +1,563 @@
+/** @file DynamicPagingSimulator.hpp
+ * @brief A dynamic paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * A simulator of demand paging.  Processes (matrices) make
+ * references to their virtual pages, and the simulator keeps
+ * track of which pages are resident in a pool of physical frames,
+ * counting the page faults and hits that result.
+ */
+#ifndef DYNAMIC_PAGING_SIMULATOR_HPP
+#define DYNAMIC_PAGING_SIMULATOR_HPP
+#include "CompressedTier.hpp"
+#include "PageReplacementPolicy.hpp"
+#include "Prefetcher.hpp"
+#include "RadixPageTable.hpp"
+#include "ReferenceAnalyzer.hpp"
+#include "Tlb.hpp"
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+/// global constants for the DynamicPagingSimulator class
+const int NO_PAGE = -1; // indicate no page loaded for indicated process/matrix
+const int NO_FRAME = -1; // indicate a page table entry is not mapped to a frame
+const int PAGE_SIZE_BYTES = 1024; // pages are 1K in size by default
+const int DEFAULT_NUM_FRAMES = 3; // by default one frame for each of the matrices A, B and C
+const int TLB_LOOKUP_CYCLES = 1; // cost of looking up a translation in the TLB
+const int PAGE_WALK_ACCESS_CYCLES = 30; // cost of reading one page table entry on a walk
+const int PREFETCH_FRAME_FRACTION = 4; // at most 1 in this many frames hold prefetched pages not referenced yet
+const int LOCAL_NODE_ACCESS_CYCLES = 80; // cost of a memory access to the NUMA node of the cpu
+const int REMOTE_NODE_ACCESS_CYCLES = 140; // cost of a memory access to another NUMA node
+const int MEMORY_ACCESS_NANOSECONDS = 100; // simulated time of a memory reference
+const int COMPRESSED_PAGE_NANOSECONDS = 10000; // simulated time to decompress a page from the compressed tier
+const int DISK_PAGE_NANOSECONDS = 5000000; // simulated time to read or write a page on disk
+const int TLB_MISS_NANOSECONDS = 30; // simulated time of the page table walk after a TLB miss
+const int MINOR_FAULT_NANOSECONDS = 1000; // simulated time of a fault that needs no I/O, e.g. zero filling a page
+const long DEFAULT_LOAD_CONTROL_WINDOW = 1000; // references the fault rate is measured over by load control
+
+/** NUMA placement
+ * Where the frames for the pages of a process are allocated when the
+ * frame pool is split into NUMA nodes.
+ */
+enum NumaPlacement
+{
+  FIRST_TOUCH_PLACEMENT, // on the home node of the process that faults the page in
+  INTERLEAVE_PLACEMENT   // spread over the nodes by virtual page number
+};
+
+/** Page table entry
+ * A single entry in the page table of a simulated process.  Page
+ * tables are kept as dense arrays of these entries indexed by the
+ * virtual page number, so looking up a reference is a simple
+ * array index rather than a search.
+ */
+struct PageTableEntry
+{
+  /// true if the page is currently resident in a physical frame
+  bool present;
+  /// the frame holding this page, or NO_FRAME if not present
+  int frame;
+  /// true if the page was prefetched and has not been referenced since
+  bool prefetched;
+  /// true if the page has been written since it was loaded, so it has
+  /// to be written back when it is replaced
+  bool dirty;
+  /// true if the page still maps the copy on write page it shares
+  /// with other processes, instead of a page of its own
+  bool shared;
+  /// true if the page was dirty when it was replaced, so it went to
+  /// swap, or is backed by the contents given for its process, so a
+  /// fault has to read it from disk instead of zero filling it
+  bool swapped;
+};
+
+/** Frame table entry
+ * Keeps track of which page of which process is held in a
+ * physical frame.
+ */
+struct FrameTableEntry
+{
+  /// the process whose page is in this frame, or NO_PROCESS if free
+  int processId;
+  /// the page held in this frame, or NO_PAGE if free
+  int pageNumber;
+  /// true if the page is a shared page, of the shared segment the
+  /// process maps
+  bool shared;
+};
+
+/// indicate a frame does not belong to any process
+const int NO_PROCESS = -1;
+/// indicate a process does not map a shared segment
+const int NO_SHARED_SEGMENT = -1;
+/// the row and column of a reference that was not made to a matrix
+/// element, e.g. replayed from a trace of page references
+const int NO_REFERENCE = -1;
+
+/** Fault log entry
+ * A record of a single page fault, kept in the optional fault log
+ * so that faults can be reported at the end of a simulation instead
+ * of as they happen.
+ */
+struct FaultLogEntry
+{
+  /// the process that faulted, and the reference that caused it, the
+  /// row and column are NO_REFERENCE for page references
+  int processId;
+  int row;
+  int col;
+  /// the page that was loaded
+  int pageNumber;
+  /// the process and page that were replaced, NO_PROCESS and NO_PAGE
+  /// if a free frame was used
+  int victimProcessId;
+  int victimPageNumber;
+};
+
+/** Cost model
+ * The simulated time each event of the simulation takes, which the
+ * simulated clock is advanced by.  A minor fault is a fault on a page
+ * that never went to swap and has no contents, which is zero filled
+ * without any I/O, a major fault reads the page from disk.  The disk serves one
+ * page at a time, and with an IOPS limit requests queue for it.
+ */
+struct CostModel
+{
+  /// a reference to a resident page
+  double hitNanoseconds;
+  /// the page table walk after a TLB miss, when the TLB is simulated
+  double tlbMissNanoseconds;
+  /// a minor fault, or copying a page on a copy on write fault
+  double minorFaultNanoseconds;
+  /// the latency of reading or writing a page on disk
+  double diskNanoseconds;
+  /// decompressing a page from the compressed tier
+  double tierNanoseconds;
+  /// the most pages the disk reads or writes a second, 0 for no limit
+  double diskIops;
+};
+
+/// the costs the simulated clock uses unless others are given
+const CostModel DEFAULT_COST_MODEL = {MEMORY_ACCESS_NANOSECONDS, TLB_MISS_NANOSECONDS, MINOR_FAULT_NANOSECONDS,
+                                      DISK_PAGE_NANOSECONDS,     COMPRESSED_PAGE_NANOSECONDS, 0.0};
+
+/** Dynamic Paging simulator
+ * Simulate dynamic paging.  Each matrix is given a "name"
+ * and its own set of pages. In this simple simulation 
+ * the matrix calls us for every page reference, and we
+ * calculate which page needs to be reference, and generate
+ * a page fualt if needed.  The pages of all of the matrices
+ * share a pool of physical frames, by default 3 frames so that
+ * there is 1 for each of the 3 expected matrices A, B and C.
+ * When no frame is free a page replacement policy chooses
+ * the victim frame.
+ */
+class DynamicPagingSimulator
+{
+private:
+  /// the paging simulator uses a flat array for the page table.
+  /// Each matrix/process A,B,C is identified by a small integer
+  /// process id, and owns a contiguous block of page table entries
+  /// starting at pageTableBase[processId].  So finding the entry
+  /// for a reference is pageTable[pageTableBase[processId] + page].
+  vector<PageTableEntry> pageTable;
+  vector<int> pageTableBase;
+  vector<int> pageTableSize;
+
+  /// the page size, which must be a power of 2, so an address is
+  /// translated to a page with a shift
+  int pageSizeBytes;
+  int pageShift;
+
+  /// a model of the multi-level page tables a real machine would
+  /// use, walked on every TLB miss, if it has any levels
+  RadixPageTable radixPageTable;
+
+  /// the TLB, consulted before the page table if it has any entries,
+  /// and the cycles spent translating references by the cost model.
+  /// Translation is only modeled if there is a TLB or page table levels
+  Tlb tlb;
+  bool modelTranslation;
+  long translationCycles;
+
+  /// the pool of physical frames, which page is in each frame,
+  /// and a stack of the frames that are still free on each NUMA node
+  int numFrames;
+  vector<FrameTableEntry> frameTable;
+  vector<vector<int>> freeFrames;
+
+  /// the frames are split evenly, in order, into NUMA nodes.  Each
+  /// process runs on a home node, and references to frames on other
+  /// nodes are remote.  Accesses are only counted with more than 1 node
+  int numNumaNodes;
+  NumaPlacement numaPlacement;
+  vector<int> homeNode;
+  long localAccesses;
+  long remoteAccesses;
+
+  /// pages shared copy on write between processes, as after a fork.
+  /// The first time a process is shared its pages move into a shared
+  /// segment here, and it and every process sharing it map the
+  /// segment, starting at sharedBase[processId], until they write a
+  /// page and get their own copy of it.  The number of processes
+  /// still mapping each shared page is kept parallel to the segments
+  vector<PageTableEntry> sharedPageTable;
+  vector<int> sharedPageSharers;
+  vector<int> sharedBase;
+  long cowFaultCount;
+  long cowCopyCount;
+
+  /// the compressed tier replaced pages go to before the disk, if it
+  /// has a capacity.  It compresses the real contents of the pages,
+  /// which processes may give, other pages are compressed as zero
+  /// filled pages
+  CompressedTier compressedTier;
+  vector<const unsigned char*> processContents;
+  vector<long> processContentBytes;
+  vector<unsigned char> pageBuffer;
+
+  /// Denning style load control, if it has a window.  The fault rate
+  /// of all of the processes is measured over windows of references.
+  /// Above the high fault rate the process faulting most is suspended,
+  /// and its pages swapped out, and below the low fault rate the
+  /// process suspended longest is resumed.  Whoever schedules the
+  /// processes must not run the suspended ones
+  long loadControlWindow;
+  double highFaultRate;
+  double lowFaultRate;
+  long windowReferences;
+  long windowFaults;
+  vector<long> windowProcessFaults;
+  vector<bool> suspended;
+  vector<bool> exited;
+  deque<int> suspendedQueue;
+  long suspensions;
+  long resumptions;
+
+  /// the page replacement policy, owned by the simulator
+  PageReplacementPolicy* policy;
+
+  /// analyzers given every reference, owned by the simulator
+  vector<ReferenceAnalyzer*> analyzers;
+
+  /// the prefetcher, owned by the simulator, or NULL for pure demand
+  /// paging, the pages it asks for, and how its prefetches turned out
+  Prefetcher* prefetcher;
+  vector<int> prefetchPages;
+  long prefetchesIssued;
+  long usefulPrefetches;
+  long wastedPrefetches;
+
+  /// names of the processes, and a map back from a name to the
+  /// process id, only needed by the string based compatibility api
+  vector<string> processNames;
+  map<string, int> processIds;
+
+  long pageFaultCount;
+  long writeBackCount;
+
+  /// the simulated clock.  Every reference takes the hit time, and
+  /// every TLB miss the time of a walk, which are counted rather than
+  /// added up as they happen, so the clock is that plus the time the
+  /// references were held up by faults.  The disk is free again at
+  /// diskFreeNanoseconds, later requests queue until then
+  CostModel costs;
+  bool displayClock;
+  long referenceCount;
+  double stallNanoseconds;
+  double diskFreeNanoseconds;
+  double diskQueueNanoseconds;
+  long diskAccesses;
+  long minorFaultCount;
+  long majorFaultCount;
+  long tierFaultCount;
+
+  /// hit and fault counts of every page, kept parallel to the page
+  /// table so they are indexed the same way as the page table entries
+  vector<long> pageHitCounts;
+  vector<long> pageFaultCounts;
+
+  /// when verbose every page fault is displayed as it happens, when
+  /// quiet faults only update the counts, and optionally are kept in
+  /// the bounded fault log which is displayed with the results
+  bool verbose;
+  bool displayPageCounts;
+  int faultLogLimit;
+  vector<FaultLogEntry> faultLog;
+  long faultLogDropped;
+
+  void reference(int processId, int pageNumber, int row, int col, bool isWrite);
+  bool referenceShared(int processId, int pageNumber, int row, int col, bool isWrite);
+  void copyOnWrite(int processId, int pageNumber, int row, int col);
+  PageTableEntry& residentEntry(int processId, int pageNumber);
+  void translate(int processId, int pageNumber);
+  void analyzeReference(int processId, int pageNumber, bool pageFault);
+  void numaAccess(int processId, int pageNumber);
+  void monitorLoad(int processId, bool pageFault);
+  void releaseFrames(int processId);
+  void handlePageFault(int processId, int pageNumber, int row, int col);
+  void prefetchHit(int processId, int pageNumber);
+  void prefetch(int processId, int pageNumber);
+  int allocateFrame(int processId, int pageNumber, int pinnedFrame = NO_PINNED_FRAME);
+  void evictFrame(int frame);
+  bool mapPage(int processId, int pageNumber, int frame, bool prefetched = false);
+  void chargePageLoad(bool swapped, bool fromTier, bool synchronous);
+  void writeBack(long numPages);
+  void diskAccess(long numPages, bool synchronous);
+  double getClockNanoseconds() const;
+  void unmapTranslation(int processId, int pageNumber, bool shared);
+  long tierKey(int processId, int pageNumber, bool shared) const;
+  void readPage(int processId, int pageNumber);
+  
+public:
+  DynamicPagingSimulator(int numFrames = DEFAULT_NUM_FRAMES, PageReplacementPolicy* policy = NULL);
+  ~DynamicPagingSimulator();
+  DynamicPagingSimulator(const DynamicPagingSimulator&) = delete;
+  DynamicPagingSimulator& operator=(const DynamicPagingSimulator&) = delete;
+  void configure(int numFrames, PageReplacementPolicy* policy);
+  void setPageSize(int pageSizeBytes);
+  int getPageSize() const;
+  void setPageTableLevels(int levels);
+  void setTlb(int numEntries, int ways, bool asidTagging);
+  void addAnalyzer(ReferenceAnalyzer* analyzer);
+  void setPrefetcher(Prefetcher* prefetcher);
+  void setNumaNodes(int numNodes, NumaPlacement placement);
+  void setCompressedTier(long capacityBytes);
+  void setLoadControl(long window, double highFaultRate, double lowFaultRate);
+  void setHomeNode(int processId, int node);
+  int getFrameNode(int frame) const;
+  void setVerbose(bool verbose);
+  void setDisplayPageCounts(bool displayPageCounts);
+  void setFaultLogLimit(int faultLogLimit);
+  void setCostModel(const CostModel& costs);
+  CostModel getCostModel() const;
+  void setDisplayClock(bool displayClock);
+  void displayResults();
+  long getPageFaultCount() const;
+  long getWriteBackCount() const;
+  long getNumReferences() const;
+  double getSimulatedSeconds() const;
+  double getEffectiveAccessNanoseconds() const;
+  void resetSimulation();
+  void addProcess(int processId, const string& processName, int numPages);
+  void addSharedProcess(int processId, const string& processName, int sourceProcessId);
+  void setProcessContents(int processId, const void* contents, long numBytes);
+  bool isSuspended(int processId) const;
+  void suspendProcess(int processId);
+  void resumeProcess(int processId);
+  void exitProcess(int processId);
+  int getProcessId(const string& processName);
+  void checkMemoryReference(int processId, int row, int col);
+  void checkMemoryReference(const string& matrixName, int row, int col);
+  void checkMemoryAddress(int processId, long virtualAddress, int row, int col, bool isWrite = false);
+  void referencePage(int processId, int pageNumber, bool isWrite = false);
+  void referenceBatch(const PageReference* references, long numReferences, bool isWrite = false);
+  bool pageFault(int processId, int pageNumber);
+  bool pageFault(const string& matrixName, int pageNumber);
+  int translateReferenceToPage(int row, int col);
+  int translateAddressToPage(long virtualAddress);
+  
+};
+
+
+// the row and column reference interface of the simulator assumes
+// 64 x 64 row major matrices of int values, the matrices of the
+// original problem set question
+const int MATRIX_SIZE = 64;
+
+
+/** reference
+ * The fast path of a memory reference, inlined into Matrix::getIndex
+ * and the trace replay loop.  When the referenced page is present
+ * this is only an array index and a test of the present bit, and
+ * counting the hit.  Only real page faults, first references to
+ * prefetched pages, and references to shared pages leave the inline
+ * path, though the replacement policy is told about every hit.
+ *
+ * @param processId The id of the matrix (process) requesting a
+ *   memory reference.
+ * @param pageNumber The virtual page being referenced.
+ * @param row, col The row and column being requested, or NO_REFERENCE
+ *   if the reference did not come from a matrix row and column.
+ * @param isWrite True if the reference is a write, which makes the
+ *   page dirty.
+ */
+inline void DynamicPagingSimulator::reference(int processId, int pageNumber, int row, int col, bool isWrite)
+{
+  int index = pageTableBase[processId] + pageNumber;
+  PageTableEntry& entry = pageTable[index];
+  referenceCount++;
+
+  if (modelTranslation)
+  {
+    translate(processId, pageNumber);
+  }
+
+  bool pageFault = not entry.present;
+  if (entry.present)
+  {
+    pageHitCounts[index]++;
+    policy->pageReferenced(entry.frame);
+    if (entry.prefetched)
+    {
+      prefetchHit(processId, pageNumber);
+    }
+  }
+  else if (entry.shared)
+  {
+    pageFault = referenceShared(processId, pageNumber, row, col, isWrite);
+  }
+  else
+  {
+    handlePageFault(processId, pageNumber, row, col);
+  }
+  if (isWrite)
+  {
+    entry.dirty = true;
+  }
+
+  if (numNumaNodes > 1)
+  {
+    numaAccess(processId, pageNumber);
+  }
+
+  if (loadControlWindow > 0)
+  {
+    monitorLoad(processId, pageFault);
+  }
+
+  if (not analyzers.empty())
+  {
+    analyzeReference(processId, pageNumber, pageFault);
+  }
+}
+
+
+/** check memory reference
+ * Simulate a reference by a matrix/process to the indicated row and
+ * column of its matrix.
+ *
+ * @param processId The id of the matrix (process) requesting a
+ *   memory reference.
+ * @param row, col The row and column being requested.
+ */
+inline void DynamicPagingSimulator::checkMemoryReference(int processId, int row, int col)
+{
+  reference(processId, translateReferenceToPage(row, col), row, col, false);
+}
+
+
+/** check memory address
+ * Simulate a reference by a matrix/process to the indicated virtual
+ * address.  The matrix works out the address of the element from its
+ * layout and element size, and we translate it to a page.
+ *
+ * @param processId The id of the matrix (process) requesting a
+ *   memory reference.
+ * @param virtualAddress The byte offset of the reference from the
+ *   start of the address space of the process.
+ * @param row, col The row and column being requested, only used to
+ *   report page faults.
+ * @param isWrite True if the reference is a write.
+ */
+inline void DynamicPagingSimulator::checkMemoryAddress(int processId, long virtualAddress, int row, int col,
+                                                       bool isWrite)
+{
+  reference(processId, translateAddressToPage(virtualAddress), row, col, isWrite);
+}
+
+
+/** reference page
+ * Simulate a reference by a process to the indicated virtual page,
+ * for example when replaying a recorded trace of page references.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ * @param isWrite True if the reference is a write.
+ */
+inline void DynamicPagingSimulator::referencePage(int processId, int pageNumber, bool isWrite)
+{
+  reference(processId, pageNumber, NO_REFERENCE, NO_REFERENCE, isWrite);
+}
+
+
+/** translate reference
+ * Translate a virtual refernce (e.g. matrix row/column) to a corresponding
+ * page number.  In this problem we are given the following information 
+ * about pages mameory:
+ *
+ *   - A page is 1K in size, or 1024 bytes
+ *   - Integers are 4 bytes long, this implies each page can 
+ *     hold 1024 / 4 = 256 values
+ *   - Each matrix in this simulation needs 64 x 64 = 4096 integer values
+ *       This can also be seen as needing 64 x 64 x 4 = 16384 bytes
+ *   - Whether you think of an array as needing 4096 values or 16384 
+ *       bytes, this means that each matrix requires 
+ *       4096 / 256 = 16384 / 1024 = 16 virtual pages of memory
+ *   
+ * So each matrix has a virtual address space with 16 pages that we will
+ * number 0 to 15.  e.g. A has pages 0 to 15, so does B.
+ * 
+ * Next we have to define a translation or mapping of a row,col reference to 
+ * a page number.  As implied in the question, the first 4 rows of a matrix,
+ * for example A[0,0] to A[3,63] should map to page 0. To calculate 
+ * the virtual page number and offset we do the following.  
+ * 
+ *     - Offset from start of virtual address space is 
+ *       row * 64 + col.  e.g. each row has 64 values, and if memory is layed
+ *       out contiguously by row, the first 64 values start from 0 to 63, then 
+ *       row 1 starts at offset 64, etc.
+ *     - Given the absolute offset, the page number is simply 
+ *       offset // 256 (integer division), e.g. the first 256 integers are on page 0, etc.
+ *     - The offset within the page (not needed for this simulation) is then
+ *       original_offset - (page * 256)
+ *
+ * This function takes the row/column virtual reference and returns the 
+ * virtual page number being referenced.  It is defined inline here
+ * because it is needed on every memory reference.
+ *
+ * @param row,col The row and column to be translated into the virtual address space
+ *   reference
+ * 
+ * @returns int Returns the virtual page number the reference falls on.
+ */
+inline int DynamicPagingSimulator::translateReferenceToPage(int row, int col)
+{
+  // each row has 64 or MATRIX_SIZE values, so absolute offset goes that number
+  // of values from 0 plus the number of values to reach the indicated column.
+  int absoluteOffset = row * MATRIX_SIZE + col;
+
+  // now determine the page number indicated by this absolute offset
+  // integer division by default, whill be the whole number of offsets
+  // we need to go, dropping any remainder.  There are 256 values on
+  // a page with the default 1K pages.
+  int pageNumber = absoluteOffset / (pageSizeBytes / int(sizeof(int)));
+
+  return pageNumber;
+}
+
+
+/** translate address
+ * Translate a virtual address, a byte offset into the address space of
+ * a process, to the virtual page number it falls on.
+ *
+ * @param virtualAddress The virtual address to translate.
+ *
+ * @returns int Returns the virtual page number the address falls on.
+ */
+inline int DynamicPagingSimulator::translateAddressToPage(long virtualAddress)
+{
+  return virtualAddress >> pageShift;
+}
+
+#endif // DYNAMIC_PAGING_SIMULATOR_HPP
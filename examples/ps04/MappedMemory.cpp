@@ -0,0 +1,106 @@
+/** @file MappedMemory.cpp
+ * @brief Real memory and page fault counts from the operating system.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the mapped memory and fault counts.
+ */
+#include "MappedMemory.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace std;
+
+
+/** mapped array constructor
+ * Map a new block of anonymous memory.  None of its pages are
+ * resident until they are first referenced.
+ *
+ * @param numBytes The size of the block in bytes.
+ */
+MappedArray::MappedArray(size_t numBytes)
+{
+  this->numBytes = numBytes;
+  address = mmap(NULL, numBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (address == MAP_FAILED)
+  {
+    cerr << "Error: MappedArray::MappedArray() could not map " << numBytes << " bytes: " << strerror(errno) << endl;
+    exit(1);
+  }
+}
+
+
+/** mapped array destructor
+ * Unmap the memory.
+ */
+MappedArray::~MappedArray()
+{
+  munmap(address, numBytes);
+}
+
+
+/** get address
+ * @returns void* The start of the mapped memory, which is page aligned.
+ */
+void* MappedArray::getAddress() const
+{
+  return address;
+}
+
+
+/** get size
+ * @returns size_t The size of the mapped memory in bytes.
+ */
+size_t MappedArray::getNumBytes() const
+{
+  return numBytes;
+}
+
+
+/** drop pages
+ * Give the pages of the array back to the operating system, so the
+ * next reference to each page faults again.  The contents of the
+ * array are lost, the pages read as zero afterwards.
+ */
+void MappedArray::dropPages()
+{
+  if (madvise(address, numBytes, MADV_DONTNEED) != 0)
+  {
+    cerr << "Error: MappedArray::dropPages() madvise failed: " << strerror(errno) << endl;
+    exit(1);
+  }
+}
+
+
+/** get fault counts
+ * @returns FaultCounts The page faults this process has taken so far.
+ */
+FaultCounts getFaultCounts()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+  {
+    cerr << "Error: getFaultCounts() getrusage failed: " << strerror(errno) << endl;
+    exit(1);
+  }
+
+  FaultCounts counts = {usage.ru_minflt, usage.ru_majflt};
+  return counts;
+}
+
+
+/** get system page size
+ * @returns long The page size of the machine we are running on.
+ */
+long getSystemPageSize()
+{
+  return sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,57 @@
+/** @file MappedMemory.hpp
+ * @brief Real memory and page fault counts from the operating system.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Support for measuring the page faults of real memory, to compare
+ * with the faults the paging simulator predicts.  Memory is mapped
+ * directly with mmap, so it is page aligned and its pages can be
+ * dropped with madvise, so the next reference to each of them faults
+ * again.  The page faults the process has taken are read with
+ * getrusage.
+ */
+#ifndef MAPPED_MEMORY_HPP
+#define MAPPED_MEMORY_HPP
+#include <cstddef>
+
+using namespace std;
+
+/** Fault counts
+ * The page faults taken by this process so far.
+ */
+struct FaultCounts
+{
+  /// faults serviced without any I/O, e.g. the first touch of a page
+  long minorFaults;
+  /// faults that needed I/O to read the page in
+  long majorFaults;
+};
+
+/** @class MappedArray
+ * @brief A block of anonymous memory mapped with mmap
+ *
+ * The memory is unmapped when the array is destroyed.
+ */
+class MappedArray
+{
+private:
+  void* address;
+  size_t numBytes;
+
+public:
+  MappedArray(size_t numBytes);
+  ~MappedArray();
+  MappedArray(const MappedArray&) = delete;
+  MappedArray& operator=(const MappedArray&) = delete;
+  void* getAddress() const;
+  size_t getNumBytes() const;
+  void dropPages();
+};
+
+FaultCounts getFaultCounts();
+long getSystemPageSize();
+
+#endif // MAPPED_MEMORY_HPP
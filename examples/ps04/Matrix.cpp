@@ -9,7 +9,9 @@
  * A matrix class for our page fault simulation.  Implements a
  * standard Matrix access, but also some hooks so we can 
  * calculate and keep track of hit or missed page references 
- * in a simulated demand paging system.
+ * in a simulated demand paging system.  The Matrix class template
+ * is implemented in the header, here we have the parts shared by
+ * all matrices.
  */
 #include <iostream>
 #include "Matrix.hpp"
@@ -18,244 +20,237 @@ using namespace std;
 
 
 
-/** default constructor
- * The default constructor for the paging simulator.  We anticipate
- * handling matrix/processes A, B and C in the simulation and initialize
- * the page table map for each with an NO_PAGE value initially.
+/** matrix base constructor
+ * A matrix that is part of the simulation of the indicated context.
+ * The matrix registers itself with the simulation once its storage
+ * is allocated.
+ *
+ * @param context The simulation the matrix is part of.
  */
-DynamicPagingSimulator::DynamicPagingSimulator()
+MatrixBase::MatrixBase(SimulationContext* context)
 {
-  // initialize the page table to be empty initially
-  pageTable["A"] = NO_PAGE;
-  pageTable["B"] = NO_PAGE;
-  pageTable["C"] = NO_PAGE;
-
-  // initialize variables to keep track of paging performance
-  pageFaultCount = 0;
+  this->context = context;
+  pager = context->getPager();
+  matrixId = NO_PROCESS;
+  baseAddress = 0;
 }
 
 
-/** paging simulator destructor
- * When the simulation ends the the paging simulator goes out of scope, 
- * display final statistics and information about the paging behavior we just
- * witnessed.
+/** get pager
+ * Access the paging simulator of the default simulation context, for
+ * example to configure the frames and replacement policy to simulate.
+ *
+ * @returns DynamicPagingSimulator* The paging simulator of the
+ *   default context.
  */
-void DynamicPagingSimulator::displayResults()
+DynamicPagingSimulator* MatrixBase::getPager()
 {
-  cout << "<DynamicPagingSimulator> paging simulation ends" << endl
-       << "    Total number of page faults seen: " << pageFaultCount << endl;
+  return SimulationContext::getDefault()->getPager();
 }
 
 
-/** reset simulation
- * Reset the simulation for another run.
+/** get arena
+ * Access the arena the storage of the matrices of the default
+ * simulation context comes from, for example to display how much of
+ * it was reused.
+ *
+ * @returns PageArena* The arena of the default context.
  */
-void DynamicPagingSimulator::resetSimulation()
+PageArena* MatrixBase::getArena()
 {
-  pageTable.clear();
-  pageTable["A"] = NO_PAGE;
-  pageTable["B"] = NO_PAGE;
-  pageTable["C"] = NO_PAGE;
-
-  pageFaultCount = 0;
+  return SimulationContext::getDefault()->getArena();
 }
 
 
-/** check for page fault
- * Check if a page fault has occurred for the indicated page number
- * memory reference.
- *
- * @param matrixName The name of the matrix/process making the page number reference.
- * @param pageNumber The page number being referenced.
+/** set recorder
+ * Start or stop recording the references of the matrices of the
+ * default simulation context.
  *
- * @returns bool True if a page fault needs to occure (the page number referenced
- *   is not loaded), or false if there is no page fault.
+ * @param recorder The recorder to record references to, or NULL to
+ *   stop recording.
  */
-bool DynamicPagingSimulator::pageFault(string matrixName, int pageNumber)
+void MatrixBase::setRecorder(TraceRecorder* recorder)
 {
-  return pageTable[matrixName] != pageNumber;
+  SimulationContext::getDefault()->setRecorder(recorder);
 }
 
 
-/** check memory referece
- * For the DynamicPagingSimulator class, called before all memory 
- * references occur so that we can simulate maintining a page table,
- * and dynamically loading needed pages before they are referenced when
- * needed.
+/** set cache
+ * Start or stop simulating the caches with the references of the
+ * matrices of the default simulation context.
  *
- * @param matrixName The name of the matrix (process) requesting a
- *   memory reference.
- * @param row, col The row and column being requested.  Think of this as 
- *   the virtual address space of the matrix/process.  We translate this 
- *   to a virtual page and offset for this simulation.
+ * @param cache The cache simulator to simulate references with, or
+ *   NULL to stop simulating the caches.
  */
-void DynamicPagingSimulator::checkMemoryReference(string matrixName, int row, int col)
+void MatrixBase::setCache(CacheSimulator* cache)
 {
-  //cout << "<DynamicPagingSimulator::checkMemoryReference> entered" << endl
-  //     << "    matrixName: " << matrixName << endl
-  //     << "    row: " << row << endl
-  //     << "    col: " << col << endl;
-  int pageNumber = translateReferenceToPage(row, col);
-
-  // check if a page fault has occurred
-  if (pageFault(matrixName, pageNumber))
-  {
-    cout << "Page Fault occurred for Matrix " << matrixName
-	 << " reference to row: " << row << " col: " << col << endl;
-    cout << "     old page: " << pageTable[matrixName] << endl;
+  SimulationContext::getDefault()->setCache(cache);
+}
 
-    // perform the page replacement
-    pageTable[matrixName] = pageNumber;
-    cout << "     new page: " << pageTable[matrixName] << endl;
 
-    // keep track of the count of page faults that occur
-    pageFaultCount++;
-  }
+/** get context
+ * @returns SimulationContext* The simulation the matrix is part of.
+ */
+SimulationContext* MatrixBase::getContext() const
+{
+  return context;
 }
 
 
-/** translate reference
- * Translate a virtual refernce (e.g. matrix row/column) to a corresponding
- * page number.  In this problem we are given the following information 
- * about pages mameory:
- *
- *   - A page is 1K in size, or 1024 bytes
- *   - Integers are 4 bytes long, this implies each page can 
- *     hold 1024 / 4 = 256 values
- *   - Each matrix in this simulation needs 64 x 64 = 4096 integer values
- *       This can also be seen as needing 64 x 64 x 4 = 16384 bytes
- *   - Whether you think of an array as needing 4096 values or 16384 
- *       bytes, this means that each matrix requires 
- *       4096 / 256 = 16384 / 1024 = 16 virtual pages of memory
- *   
- * So each matrix has a virtual address space with 16 pages that we will
- * number 0 to 15.  e.g. A has pages 0 to 15, so does B.
- * 
- * Next we have to define a translation or mapping of a row,col reference to 
- * a page number.  As implied in the question, the first 4 rows of a matrix,
- * for example A[0,0] to A[3,63] should map to page 0. To calculate 
- * the virtual page number and offset we do the following.  
- * 
- *     - Offset from start of virtual address space is 
- *       row * 64 + col.  e.g. each row has 64 values, and if memory is layed
- *       out contiguously by row, the first 64 values start from 0 to 63, then 
- *       row 1 starts at offset 64, etc.
- *     - Given the absolute offset, the page number is simply 
- *       offset // 256 (integer division), e.g. the first 256 integers are on page 0, etc.
- *     - The offset within the page (not needed for this simulation) is then
- *       original_offset - (page * 256)
- *
- * This function takes the row/column virtual reference and returns the 
- * virtual page number being referenced.
+/** register matrix
+ * Called when a new matrix is constructed, to give it the next id and
+ * a name, and make it known to the paging simulator as a new process.
  *
- * @param row,col The row and column to be translated into the virtual address space
- *   reference
- * 
- * @returns int Returns the virtual page number the reference falls on.
+ * @param contents The matrix storage, whose contents are compressed
+ *   if the paging simulator has a compressed tier.
+ * @param storageBytes The size of the matrix storage in bytes, which
+ *   is the size of the virtual address space of the matrix/process.
+ * @param elementBytes The size of the matrix elements in bytes.
+ * @param sourceMatrixId The matrix whose pages this matrix shares copy
+ *   on write, or NO_PROCESS if its pages are its own.
  */
-int DynamicPagingSimulator::translateReferenceToPage(int row, int col)
+void MatrixBase::registerMatrix(const void* contents, long storageBytes, int elementBytes, int sourceMatrixId)
 {
-  // each row has 64 or MATRIX_SIZE values, so absolute offset goes that number
-  // of values from 0 plus the number of values to reach the indicated column.
-  int absoluteOffset = row * MATRIX_SIZE + col;
+  // assign the next matrix id of the simulation to this new matrix
+  matrixId = context->allocateMatrixId();
 
-  // now determine the page number indicated by this absolute offset
-  // integer division by default, whill be the whole number of offsets
-  // we need to go, dropping any remainder
-  int pageNumber = absoluteOffset / PAGE_SIZE_VALUES;
+  // generate a name, first matrix gets named A, etc.
+  matrixName = SimulationContext::matrixName(matrixId);
+
+  // and make ourself known to the paging system, and the recorder
+  int numPages = pager->translateAddressToPage(storageBytes - 1) + 1;
+  if (sourceMatrixId == NO_PROCESS)
+  {
+    pager->addProcess(matrixId, matrixName, numPages);
+  }
+  else
+  {
+    pager->addSharedProcess(matrixId, matrixName, sourceMatrixId);
+  }
+  pager->setProcessContents(matrixId, contents, storageBytes);
+  TraceRecorder* recorder = context->getRecorder();
+  if (recorder != NULL)
+  {
+    recorder->addProcess(matrixId, matrixName, numPages, elementBytes);
+  }
 
-  return pageNumber;
+  // and place ourself in the address space seen by the caches
+  baseAddress = context->allocateBaseAddress(long(numPages) * pager->getPageSize());
 }
 
 
+/** allocate storage
+ * Allocate the storage of a new matrix from the arena, starting on a
+ * page boundary of both the simulated and the real pages.
+ *
+ * @param storageBytes The size of the storage in bytes.
+ *
+ * @returns void* The start of the storage.
+ */
+void* MatrixBase::allocateStorage(long storageBytes)
+{
+  PageArena* arena = context->getArena();
+  arena->setAlignment(pager->getPageSize());
+  return arena->allocate(storageBytes);
+}
 
-// need to initialize static member variables external to declaration
-// in class header
-int Matrix::nextMatrixId = 0;
-DynamicPagingSimulator* Matrix::pager = new DynamicPagingSimulator();
 
-/** normal constructor
- * Normal constructor for the class.  Memory is allocated STATICALLY
- * for this class.  So We enforce everyone always creates matrices
- * with 64 rows and 64 columns for this simulation.
+/** release storage
+ * Give the storage of a matrix back to the arena.
  *
- * @param numRows The number of rows in the 2D matrix, must be 64
- *   for this simulation.
- * @param numCols The number of columns in this 2D matrix, must be
- *   64 for this simulation.
+ * @param storage The start of the storage.
+ * @param storageBytes The size of the storage in bytes.
  */
-Matrix::Matrix(int numRows, int numCols)
+void MatrixBase::releaseStorage(void* storage, long storageBytes)
 {
-  // enforce always 64 rows and columns for this simulation
-  if ( (numRows != MATRIX_SIZE) or (numCols != MATRIX_SIZE) )
-  {
-    cerr << "Error: Matrix::Matrix() constructor must be constructed" << endl
-	 << "   with 64 rows and 64 columns for this simulation" << endl;
-    exit(1);
-  }
+  context->getArena()->release(storage, storageBytes);
+}
 
-  // otherwise ok to dynamically allocate memory and initialize
-  this->numRows = numRows;
-  this->numCols = numCols;
 
-  int value = 1;
-  for (int row = 0; row < numRows; row++)
+/** reference range
+ * Called by kernels for a range of contiguous elements they touch, to
+ * simulate a reference to each page of the range, and to each cache
+ * line if the caches are being simulated.  When recording, the first
+ * element of the range on each page is recorded, so the recording
+ * has the same page references.
+ *
+ * @param offset The offset of the first element in the matrix storage.
+ * @param numElements The number of elements in the range.
+ * @param elementBytes The size of the matrix elements.
+ * @param isWrite True if the range is being written.
+ */
+void MatrixBase::referenceRange(long offset, long numElements, int elementBytes, bool isWrite) const
+{
+  long firstAddress = offset * elementBytes;
+  long lastAddress = (offset + numElements) * elementBytes - 1;
+  long pageSizeBytes = pager->getPageSize();
+  TraceRecorder* recorder = context->getRecorder();
+
+  long address = firstAddress;
+  while (address <= lastAddress)
   {
-    for (int col = 0; col < numCols; col++)
+    pager->checkMemoryAddress(matrixId, address, NO_REFERENCE, NO_REFERENCE, isWrite);
+    if (recorder != NULL)
     {
-      values[row][col] = value++;
+      recorder->record(matrixId, address / elementBytes, isWrite);
     }
+    address = (address / pageSizeBytes + 1) * pageSizeBytes;
   }
 
-  // assign the next matrix id to this new matrix
-  matrixId = nextMatrixId;
-  nextMatrixId++;
-
-  // generate a name, first matrix gets named A, etc.
-  char nameChar = char('A' + matrixId);
-  matrixName = string(1, nameChar);
+  CacheSimulator* cache = context->getCache();
+  if (cache != NULL)
+  {
+    cache->accessRange(baseAddress + firstAddress, lastAddress - firstAddress + 1, isWrite);
+  }
 }
 
 
-/** get index reference
- * Retrieve value at indicated row and column index of this matrix.
- * This is the basis of something like an oveloaded operator[][]
- * member function for this 2-D matrix.
- * We actually return a reference back to the caller.  So the caller
- * can use the value (a read) or can actuall assign into the value
- * (a write) using the returned memory reference.
- *
- * @param row The row index of the 2-D matrix to access
- * @param col The column index of the 2-D matrix to access
+/** reference elements
+ * Called by the row and column range accessors, to simulate the
+ * references to the elements at rangeOffsets, in order.  The paging
+ * simulator is given them as one batch, so that the references to
+ * each page are simulated together.  They are recorded, and go
+ * through the caches, one at a time as element references do.
  *
- * @returns int& Retuns a reference to the integer memory in this matrix
- *   at matrix[row][col].
+ * @param elementBytes The size of the matrix elements.
+ * @param isWrite True if the elements are being written.
  */
-int& Matrix::getIndex(int row, int col)
+void MatrixBase::referenceElements(int elementBytes, bool isWrite) const
 {
-  // we could do some bounds checking here to make sure the
-  // reference is legal and in the bounds of our matrix, but
-  // not really needed in this small simulation
-
-  // call the pager as if the next reference is going through the cpu
-  // and it will determine if the reference is in memory or needs to be
-  // paged in
-  pager->checkMemoryReference(matrixName, row, col);
-  
-  // simply access the row and column of our private values
-  // integer matrix.  The reference to this value is returned
-  // from this function.
-  return values[row][col];
+  int numElements = rangeOffsets.size();
+  rangeReferences.resize(numElements);
+  for (int element = 0; element < numElements; element++)
+  {
+    rangeReferences[element].processId = matrixId;
+    rangeReferences[element].pageNumber = pager->translateAddressToPage(rangeOffsets[element] * elementBytes);
+  }
+  pager->referenceBatch(rangeReferences.data(), numElements, isWrite);
+
+  TraceRecorder* recorder = context->getRecorder();
+  if (recorder != NULL)
+  {
+    for (long offset : rangeOffsets)
+    {
+      recorder->record(matrixId, offset, isWrite);
+    }
+  }
+
+  CacheSimulator* cache = context->getCache();
+  if (cache != NULL)
+  {
+    for (long offset : rangeOffsets)
+    {
+      cache->access(baseAddress + offset * elementBytes, isWrite);
+    }
+  }
 }
 
 
 /** end simulation
- * Called on one of the matrixes to end the current simulation and 
- * clean up.
+ * Called on one of the matrixes to end the current simulation of its
+ * context and clean up.
  */
-void Matrix::endSimulation()
+void MatrixBase::endSimulation()
 {
-  nextMatrixId = 0;
-  pager->displayResults();
-  pager->resetSimulation();
+  context->endSimulation();
 }
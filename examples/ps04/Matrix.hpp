@@ -7,89 +7,715 @@
  * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
  *
  * A matrix class for our page fault simulation.  Implements a
- * standard Matrix access, but also some hooks so we can 
- * calculate and keep track of hit or missed page references 
+ * standard Matrix access, but also some hooks so we can
+ * calculate and keep track of hit or missed page references
  * in a simulated demand paging system.
+ *
+ * The Matrix is a class template, parameterized on the type of its
+ * elements, its dimensions, and the layout of the elements in
+ * memory.  The dimensions can be fixed at compile time, or given
+ * when the matrix is constructed.  The virtual address of each
+ * element reference is worked out from the layout and the size of
+ * the elements, so the pages referenced are those a real program
+ * using the same matrix would reference.
  */
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+#include "DynamicPagingSimulator.hpp"
+#include "SimulationContext.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
-#include <map>
 #include <string>
+#include <vector>
 
 using namespace std;
 
 
 
-/// global constants for the DynamicPagingSimulator class
-const int NO_PAGE = -1; // indicate no page loaded for indicated process/matrix
-const int PAGE_SIZE_BYTES = 1024; // pages are 1K in size
-const int PAGE_SIZE_VALUES = PAGE_SIZE_BYTES / 4; // there are 256 int values on a page
+/// a Matrix dimension of DYNAMIC_SIZE is given at run time when the
+/// matrix is constructed, instead of being fixed at compile time
+const int DYNAMIC_SIZE = 0;
 
-/** Dynamic Paging simulator
- * Simulate dynamic paging.  Each matrix is given a "name"
- * and its own set of pages. In this simple simulation 
- * the matrix calls us for every page reference, and we
- * calculate which page needs to be reference, and generate
- * a page fualt if needed.  For simplicity we only keep the 
- * 3 pages needed for the 3 expected matrices A, B and C
+/** Row major layout
+ * The elements of each row are contiguous in memory, row 0 first,
+ * as C and C++ lay out 2-D arrays.
  */
-class DynamicPagingSimulator
+struct RowMajor
 {
-private:
-  /// the paging simulator uses a map for the page table.
-  /// Each matrix/process A,B,C has a single page loaded, which
-  /// is kept track of in this map.  The map maps the
-  /// matrix/process name to the page number currently in
-  /// memory
-  map<string, int> pageTable;
-  int pageFaultCount;
-  
-public:
-  DynamicPagingSimulator();
-  void displayResults();
-  void resetSimulation();
-  void checkMemoryReference(string matrixName, int row, int col);
-  bool pageFault(string matrixName, int pageNumber);
-  int translateReferenceToPage(int row, int col);
-  
+  /// the elements of a row, or a column, are contiguous in memory
+  static const bool rowsContiguous = true;
+  static const bool colsContiguous = false;
+
+  static long offset(int row, int col, int numRows, int numCols)
+  {
+    return long(row) * numCols + col;
+  }
+
+  static long storageSize(int numRows, int numCols)
+  {
+    return long(numRows) * numCols;
+  }
+};
+
+/** Column major layout
+ * The elements of each column are contiguous in memory, column 0
+ * first, as Fortran lays out 2-D arrays.
+ */
+struct ColumnMajor
+{
+  static const bool rowsContiguous = false;
+  static const bool colsContiguous = true;
+
+  static long offset(int row, int col, int numRows, int numCols)
+  {
+    return long(col) * numRows + row;
+  }
+
+  static long storageSize(int numRows, int numCols)
+  {
+    return long(numRows) * numCols;
+  }
 };
 
+/** Tiled layout
+ * The matrix is divided into tiles of TileRows x TileCols elements.
+ * The elements of each tile are contiguous in memory in row major
+ * order, and the tiles themselves are laid out in row major order.
+ * Matrices whose size is not a multiple of the tile size are padded
+ * out to whole tiles.
+ */
+template <int TileRows, int TileCols>
+struct Tiled
+{
+  static const bool rowsContiguous = false;
+  static const bool colsContiguous = false;
+
+  static long offset(int row, int col, int numRows, int numCols)
+  {
+    long tilesPerRow = (numCols + TileCols - 1) / TileCols;
+    long tile = (row / TileRows) * tilesPerRow + (col / TileCols);
+    return tile * (TileRows * TileCols) + (row % TileRows) * TileCols + (col % TileCols);
+  }
+
+  static long storageSize(int numRows, int numCols)
+  {
+    long tileRows = (numRows + TileRows - 1) / TileRows;
+    long tileCols = (numCols + TileCols - 1) / TileCols;
+    return tileRows * tileCols * TileRows * TileCols;
+  }
+};
+
+/** Matrix Base Class
+ * The parts of a matrix that do not depend on its element type,
+ * size or layout.  In particular all matrices, whatever their type,
+ * of a simulation share the paging simulator and id numbering of the
+ * simulation context they are constructed in.
+ */
+class MatrixBase
+{
+protected:
+  /// the simulation the matrix is part of, and its paging simulator,
+  /// which every reference goes to
+  SimulationContext* context;
+  DynamicPagingSimulator* pager;
+
+  /// The "name" we are known by by the paging system
+  int matrixId;
+  string matrixName;
 
-// we statically allocate 2D matrix of this size to use,
-const int MATRIX_SIZE = 64;
+  /// where the matrix is in the address space seen by the caches
+  long baseAddress;
+
+  // the offsets of the elements of a row or column range, and the
+  // page references to them, simulated as one batch of references
+  mutable vector<long> rangeOffsets;
+  mutable vector<PageReference> rangeReferences;
+
+  MatrixBase(SimulationContext* context);
+  void* allocateStorage(long storageBytes);
+  void releaseStorage(void* storage, long storageBytes);
+  void registerMatrix(const void* contents, long storageBytes, int elementBytes, int sourceMatrixId = NO_PROCESS);
+  void reference(long offset, int elementBytes, int row, int col, bool isWrite) const;
+  void referenceRange(long offset, long numElements, int elementBytes, bool isWrite) const;
+  void referenceElements(int elementBytes, bool isWrite) const;
+
+public:
+  // the default simulation context, for matrices constructed without one
+  static DynamicPagingSimulator* getPager();
+  static PageArena* getArena();
+  static void setRecorder(TraceRecorder* recorder);
+  static void setCache(CacheSimulator* cache);
+
+  SimulationContext* getContext() const;
+  void endSimulation();
+};
 
 /** Matrix Class
  * A simple class to encapsulate a matrix.  We also put in hooks for
  * our simulation so we can calculate and detect and implement
  * paging and page faults for the simulation.
+ *
+ * @tparam T The type of the matrix elements.
+ * @tparam Rows, Cols The dimensions of the matrix, or DYNAMIC_SIZE
+ *   if they are given at run time.
+ * @tparam Layout The layout of the matrix elements in memory,
+ *   RowMajor, ColumnMajor or Tiled.
  */
-class Matrix
+template <class T, int Rows = DYNAMIC_SIZE, int Cols = DYNAMIC_SIZE, class Layout = RowMajor>
+class Matrix : public MatrixBase
 {
 private:
-  /// A private actual array of 2-D values
+  /// A private actual array of 2-D values, in the order given by the
+  /// layout, allocated from the arena
   int numRows;
   int numCols;
-  int values[MATRIX_SIZE][MATRIX_SIZE];
+  long numValues;
+  T* values;
 
-  /// The "name" we are known by by the paging system
-  static int nextMatrixId;
-  int matrixId;
-  string matrixName;
-  
-  // All matrix clases will have a reference to the same
-  // paging simulator for this simulation
-  static DynamicPagingSimulator* pager;
-  
+  void initialize(int numRows, int numCols);
+  void referenceLine(int row, int col, int numElements, bool alongRow, bool isWrite) const;
 
 public:
-  // constructors and destructors
-  Matrix(int numRows, int numCols);
-  
+  /** Element Class
+   * A reference to one element of the matrix, returned by getIndex.
+   * Reading the element, by converting it to a T, is simulated as a
+   * read reference, and assigning to it as a write reference, so the
+   * simulation can tell which pages are dirtied.
+   */
+  class Element
+  {
+  private:
+    Matrix& matrix;
+    long offset;
+    int row;
+    int col;
+
+  public:
+    Element(Matrix& matrix, long offset, int row, int col);
+
+    operator T() const;
+    Element& operator=(const T& value);
+    Element& operator=(const Element& other);
+    Element& operator+=(const T& value);
+    Element& operator-=(const T& value);
+    Element& operator*=(const T& value);
+  };
+
+  // constructors and destructors, the matrix is part of the
+  // simulation of the indicated context, or of the default context
+  explicit Matrix(SimulationContext* context = SimulationContext::getDefault());
+  Matrix(int numRows, int numCols, SimulationContext* context = SimulationContext::getDefault());
+  Matrix(const Matrix& source);
+  ~Matrix();
+  Matrix& operator=(const Matrix&) = delete;
+
+  int getNumRows() const;
+  int getNumCols() const;
+  static long elementOffset(int row, int col, int numRows, int numCols);
+
   // we could get fancy and overload operator[], but overloading 2-D or higher
   // indexing operation is tricky, so we'll keep it a bit simpler and define
   // a member function<
-  int& getIndex(int row, int col);
+  Element getIndex(int row, int col);
+  T getIndex(int row, int col) const;
 
-  void endSimulation();
-public:
+  // read or write a range of a row or column of the matrix, simulated
+  // as one batch of references rather than a reference per element
+  void getRow(int row, int col, int numCols, T* rowValues) const;
+  void setRow(int row, int col, int numCols, const T* rowValues);
+  void getCol(int row, int col, int numRows, T* colValues) const;
+  void setCol(int row, int col, int numRows, const T* colValues);
+
+  // direct access to the values for kernels working on whole blocks,
+  // which report the pages of each block they touch instead
+  T* getData();
+  void touchBlock(int row, int col, int numRows, int numCols, bool isWrite);
 };
 
+
+/** reference
+ * Called on every element reference, to simulate the reference with
+ * the paging simulator, and the caches if they are being simulated,
+ * and record it if recording.
+ *
+ * @param offset The offset of the element in the matrix storage.
+ * @param elementBytes The size of the matrix elements.
+ * @param row, col The row and column of the element.
+ * @param isWrite True if the element is being written.
+ */
+inline void MatrixBase::reference(long offset, int elementBytes, int row, int col, bool isWrite) const
+{
+  // call the pager as if the next reference is going through the cpu
+  // and it will determine if the reference is in memory or needs to be
+  // paged in
+  pager->checkMemoryAddress(matrixId, offset * elementBytes, row, col, isWrite);
+
+  TraceRecorder* recorder = context->getRecorder();
+  if (recorder != NULL)
+  {
+    recorder->record(matrixId, offset, isWrite);
+  }
+
+  CacheSimulator* cache = context->getCache();
+  if (cache != NULL)
+  {
+    cache->access(baseAddress + offset * elementBytes, isWrite);
+  }
+}
+
+
+/** default constructor
+ * Construct a matrix whose dimensions are fixed at compile time.
+ *
+ * @param context The simulation the matrix is part of.
+ */
+template <class T, int Rows, int Cols, class Layout>
+Matrix<T, Rows, Cols, Layout>::Matrix(SimulationContext* context) : MatrixBase(context)
+{
+  if ((Rows == DYNAMIC_SIZE) or (Cols == DYNAMIC_SIZE))
+  {
+    cerr << "Error: Matrix::Matrix() the number of rows and columns" << endl
+         << "   must be given for a matrix without a compile time size" << endl;
+    exit(1);
+  }
+
+  initialize(Rows, Cols);
+}
+
+
+/** normal constructor
+ * Normal constructor for the class.  For a matrix whose dimensions
+ * are fixed at compile time they must agree with the dimensions
+ * given.
+ *
+ * @param numRows The number of rows in the 2D matrix.
+ * @param numCols The number of columns in this 2D matrix.
+ * @param context The simulation the matrix is part of.
+ */
+template <class T, int Rows, int Cols, class Layout>
+Matrix<T, Rows, Cols, Layout>::Matrix(int numRows, int numCols, SimulationContext* context) : MatrixBase(context)
+{
+  if ((numRows < 1) or (numCols < 1) or ((Rows != DYNAMIC_SIZE) and (numRows != Rows)) or
+      ((Cols != DYNAMIC_SIZE) and (numCols != Cols)))
+  {
+    cerr << "Error: Matrix::Matrix() constructor can not construct a" << endl
+         << "   matrix with " << numRows << " rows and " << numCols << " columns" << endl;
+    exit(1);
+  }
+
+  initialize(numRows, numCols);
+}
+
+
+/** copy constructor
+ * A copy of a matrix is a new matrix/process that shares the pages
+ * of the source copy on write, as a process forked from the process
+ * holding the source would.  Its pages stay shared with the source
+ * until one of them writes a page.  The copy is part of the same
+ * simulation as the source.
+ *
+ * @param source The matrix to copy.
+ */
+template <class T, int Rows, int Cols, class Layout>
+Matrix<T, Rows, Cols, Layout>::Matrix(const Matrix& source)
+  : MatrixBase(source.context), numRows(source.numRows), numCols(source.numCols), numValues(source.numValues)
+{
+  values = static_cast<T*>(allocateStorage(numValues * sizeof(T)));
+  copy(source.values, source.values + numValues, values);
+  registerMatrix(values, numValues * sizeof(T), sizeof(T), source.matrixId);
+}
+
+
+/** destructor
+ * Give the storage of the matrix back to the arena.
+ */
+template <class T, int Rows, int Cols, class Layout>
+Matrix<T, Rows, Cols, Layout>::~Matrix()
+{
+  releaseStorage(values, numValues * sizeof(T));
+}
+
+
+/** initialize
+ * Allocate and initialize the values of a new matrix, and register it
+ * with the paging simulation.  The values are initialized to 1, 2,
+ * 3... in row major order, whatever the layout, and any padding of
+ * the layout to 0.
+ *
+ * @param numRows The number of rows in the 2D matrix.
+ * @param numCols The number of columns in this 2D matrix.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::initialize(int numRows, int numCols)
+{
+  this->numRows = numRows;
+  this->numCols = numCols;
+  numValues = Layout::storageSize(numRows, numCols);
+  values = static_cast<T*>(allocateStorage(numValues * sizeof(T)));
+  fill(values, values + numValues, T());
+
+  T value = 1;
+  for (int row = 0; row < numRows; row++)
+  {
+    for (int col = 0; col < numCols; col++)
+    {
+      values[elementOffset(row, col, numRows, numCols)] = value;
+      value = value + 1;
+    }
+  }
+
+  registerMatrix(values, numValues * sizeof(T), sizeof(T));
+}
+
+
+/** number of rows
+ * @returns int The number of rows of the matrix.
+ */
+template <class T, int Rows, int Cols, class Layout>
+int Matrix<T, Rows, Cols, Layout>::getNumRows() const
+{
+  return (Rows == DYNAMIC_SIZE) ? numRows : Rows;
+}
+
+
+/** number of columns
+ * @returns int The number of columns of the matrix.
+ */
+template <class T, int Rows, int Cols, class Layout>
+int Matrix<T, Rows, Cols, Layout>::getNumCols() const
+{
+  return (Cols == DYNAMIC_SIZE) ? numCols : Cols;
+}
+
+
+/** element offset
+ * The offset of an element from the start of the matrix storage, in
+ * elements, as determined by the layout of the matrix.  Multiplying
+ * by sizeof(T) gives the virtual address of the element.
+ *
+ * @param row, col The row and column of the element.
+ * @param numRows, numCols The dimensions of the matrix.
+ *
+ * @returns long The offset of the element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+long Matrix<T, Rows, Cols, Layout>::elementOffset(int row, int col, int numRows, int numCols)
+{
+  // use the compile time dimensions if we have them, so the offset
+  // calculation can be simplified by the compiler
+  return Layout::offset(row, col, (Rows == DYNAMIC_SIZE) ? numRows : Rows, (Cols == DYNAMIC_SIZE) ? numCols : Cols);
+}
+
+
+/** get index reference
+ * Retrieve the element at indicated row and column index of this
+ * matrix.  This is the basis of something like an oveloaded
+ * operator[][] member function for this 2-D matrix.
+ * We return an Element referring to the value, so the caller can
+ * use the value (a read) or can assign into the value (a write), and
+ * the simulation sees which it was.
+ *
+ * @param row The row index of the 2-D matrix to access
+ * @param col The column index of the 2-D matrix to access
+ *
+ * @returns Element Retuns a reference to the element of this matrix
+ *   at matrix[row][col].
+ */
+template <class T, int Rows, int Cols, class Layout>
+typename Matrix<T, Rows, Cols, Layout>::Element Matrix<T, Rows, Cols, Layout>::getIndex(int row, int col)
+{
+  // we could do some bounds checking here to make sure the
+  // reference is legal and in the bounds of our matrix, but
+  // not really needed in this small simulation
+  return Element(*this, elementOffset(row, col, numRows, numCols), row, col);
+}
+
+
+/** get index value
+ * Read the value at indicated row and column index of a const
+ * matrix, simulated as a read reference.
+ *
+ * @param row The row index of the 2-D matrix to access
+ * @param col The column index of the 2-D matrix to access
+ *
+ * @returns T The value of matrix[row][col].
+ */
+template <class T, int Rows, int Cols, class Layout>
+T Matrix<T, Rows, Cols, Layout>::getIndex(int row, int col) const
+{
+  long offset = elementOffset(row, col, numRows, numCols);
+  reference(offset, sizeof(T), row, col, false);
+  return values[offset];
+}
+
+
+/** reference line
+ * Simulate the references to a range of the elements of a row or
+ * column, in order, as one batch.  The offsets of the elements are
+ * left in rangeOffsets for the caller to access them.
+ *
+ * @param row, col The first element of the range.
+ * @param numElements The number of elements in the range.
+ * @param alongRow True if the range is along a row, false if it is
+ *   down a column.
+ * @param isWrite True if the elements are being written.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::referenceLine(int row, int col, int numElements, bool alongRow,
+                                                  bool isWrite) const
+{
+  rangeOffsets.resize(numElements);
+  for (int element = 0; element < numElements; element++)
+  {
+    rangeOffsets[element] = alongRow ? elementOffset(row, col + element, numRows, numCols)
+                                     : elementOffset(row + element, col, numRows, numCols);
+  }
+  referenceElements(sizeof(T), isWrite);
+}
+
+
+/** get row
+ * Read a range of a row of the matrix, simulated as a read reference
+ * to each element, made as one batch.
+ *
+ * @param row The row to read.
+ * @param col The first column of the range.
+ * @param numCols The number of columns in the range.
+ * @param rowValues Returns the values of the range.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::getRow(int row, int col, int numCols, T* rowValues) const
+{
+  referenceLine(row, col, numCols, true, false);
+  for (int element = 0; element < numCols; element++)
+  {
+    rowValues[element] = values[rangeOffsets[element]];
+  }
+}
+
+
+/** set row
+ * Write a range of a row of the matrix, simulated as a write
+ * reference to each element, made as one batch.
+ *
+ * @param row The row to write.
+ * @param col The first column of the range.
+ * @param numCols The number of columns in the range.
+ * @param rowValues The new values of the range.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::setRow(int row, int col, int numCols, const T* rowValues)
+{
+  referenceLine(row, col, numCols, true, true);
+  for (int element = 0; element < numCols; element++)
+  {
+    values[rangeOffsets[element]] = rowValues[element];
+  }
+}
+
+
+/** get column
+ * Read a range of a column of the matrix, simulated as a read
+ * reference to each element, made as one batch.
+ *
+ * @param row The first row of the range.
+ * @param col The column to read.
+ * @param numRows The number of rows in the range.
+ * @param colValues Returns the values of the range.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::getCol(int row, int col, int numRows, T* colValues) const
+{
+  referenceLine(row, col, numRows, false, false);
+  for (int element = 0; element < numRows; element++)
+  {
+    colValues[element] = values[rangeOffsets[element]];
+  }
+}
+
+
+/** set column
+ * Write a range of a column of the matrix, simulated as a write
+ * reference to each element, made as one batch.
+ *
+ * @param row The first row of the range.
+ * @param col The column to write.
+ * @param numRows The number of rows in the range.
+ * @param colValues The new values of the range.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::setCol(int row, int col, int numRows, const T* colValues)
+{
+  referenceLine(row, col, numRows, false, true);
+  for (int element = 0; element < numRows; element++)
+  {
+    values[rangeOffsets[element]] = colValues[element];
+  }
+}
+
+
+/** get data
+ * The values of the matrix, in the order given by the layout, so
+ * that the element at row and column is at elementOffset(row, col).
+ * References made through the returned pointer are not simulated,
+ * kernels using it report the blocks they touch with touchBlock().
+ *
+ * @returns T* The start of the matrix values.
+ */
+template <class T, int Rows, int Cols, class Layout>
+T* Matrix<T, Rows, Cols, Layout>::getData()
+{
+  return values;
+}
+
+
+/** touch block
+ * Report the pages of a block of the matrix to the simulation, once
+ * for each page, as a kernel working on the block would reference
+ * them.  Rows (or columns) that are contiguous in memory are reported
+ * as a range, otherwise each page is reported when the elements of
+ * the block move on to it.
+ *
+ * @param row, col The first row and column of the block.
+ * @param numRows, numCols The size of the block.
+ * @param isWrite True if the kernel writes the block.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void Matrix<T, Rows, Cols, Layout>::touchBlock(int row, int col, int numRows, int numCols, bool isWrite)
+{
+  if (Layout::rowsContiguous)
+  {
+    for (int blockRow = row; blockRow < row + numRows; blockRow++)
+    {
+      referenceRange(elementOffset(blockRow, col, this->numRows, this->numCols), numCols, sizeof(T), isWrite);
+    }
+  }
+  else if (Layout::colsContiguous)
+  {
+    for (int blockCol = col; blockCol < col + numCols; blockCol++)
+    {
+      referenceRange(elementOffset(row, blockCol, this->numRows, this->numCols), numRows, sizeof(T), isWrite);
+    }
+  }
+  else
+  {
+    long lastPage = NO_PAGE;
+    for (int blockRow = row; blockRow < row + numRows; blockRow++)
+    {
+      for (int blockCol = col; blockCol < col + numCols; blockCol++)
+      {
+        long offset = elementOffset(blockRow, blockCol, this->numRows, this->numCols);
+        long page = pager->translateAddressToPage(offset * sizeof(T));
+        if (page != lastPage)
+        {
+          referenceRange(offset, 1, sizeof(T), isWrite);
+          lastPage = page;
+        }
+      }
+    }
+  }
+}
+
+
+
+/** element constructor
+ * Refer to one element of a matrix.
+ *
+ * @param matrix The matrix the element is in.
+ * @param offset The offset of the element in the matrix storage.
+ * @param row, col The row and column of the element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+Matrix<T, Rows, Cols, Layout>::Element::Element(Matrix& matrix, long offset, int row, int col)
+  : matrix(matrix), offset(offset), row(row), col(col)
+{
+}
+
+
+/** read element
+ * Read the value of the element, simulated as a read reference.
+ *
+ * @returns T The value of the element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+Matrix<T, Rows, Cols, Layout>::Element::operator T() const
+{
+  matrix.reference(offset, sizeof(T), row, col, false);
+  return matrix.values[offset];
+}
+
+
+/** write element
+ * Assign a new value to the element, simulated as a write reference.
+ *
+ * @param value The new value of the element.
+ *
+ * @returns Element& This element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+typename Matrix<T, Rows, Cols, Layout>::Element& Matrix<T, Rows, Cols, Layout>::Element::operator=(const T& value)
+{
+  matrix.reference(offset, sizeof(T), row, col, true);
+  matrix.values[offset] = value;
+  return *this;
+}
+
+
+/** copy element
+ * Assign the value of another element to this one, a read of the
+ * other element followed by a write of this one.
+ *
+ * @param other The element to copy the value of.
+ *
+ * @returns Element& This element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+typename Matrix<T, Rows, Cols, Layout>::Element& Matrix<T, Rows, Cols, Layout>::Element::operator=(const Element& other)
+{
+  return *this = static_cast<T>(other);
+}
+
+
+/** add to element
+ * A read of the element followed by a write of it.
+ *
+ * @param value The value to add to the element.
+ *
+ * @returns Element& This element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+typename Matrix<T, Rows, Cols, Layout>::Element& Matrix<T, Rows, Cols, Layout>::Element::operator+=(const T& value)
+{
+  return *this = static_cast<T>(*this) + value;
+}
+
+
+/** subtract from element
+ * A read of the element followed by a write of it.
+ *
+ * @param value The value to subtract from the element.
+ *
+ * @returns Element& This element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+typename Matrix<T, Rows, Cols, Layout>::Element& Matrix<T, Rows, Cols, Layout>::Element::operator-=(const T& value)
+{
+  return *this = static_cast<T>(*this) - value;
+}
+
+
+/** multiply element
+ * A read of the element followed by a write of it.
+ *
+ * @param value The value to multiply the element by.
+ *
+ * @returns Element& This element.
+ */
+template <class T, int Rows, int Cols, class Layout>
+typename Matrix<T, Rows, Cols, Layout>::Element& Matrix<T, Rows, Cols, Layout>::Element::operator*=(const T& value)
+{
+  return *this = static_cast<T>(*this) * value;
+}
+
+#endif // MATRIX_HPP
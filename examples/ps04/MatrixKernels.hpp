@@ -0,0 +1,478 @@
+/** @file MatrixKernels.hpp
+ * @brief Blocked and vectorized kernels on the Matrix class.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Matrix add, multiply and transpose kernels as a real program would
+ * write them.  The matrices are worked on a tile (block) at a time,
+ * so the elements of a tile stay in the caches while they are used,
+ * and the inner loops run directly over the matrix values, using
+ * AVX2 or SSE2 instructions when the compiler targets them, instead
+ * of going through Matrix::getIndex for every element.  The pages of
+ * each tile are still reported to the paging simulation before the
+ * tile is worked on, so both the real throughput of the kernels and
+ * their simulated page faults can be measured.
+ *
+ * The tiles are visited in row major or column major order, as asked
+ * for, to compare the loop orders.
+ */
+#ifndef MATRIX_KERNELS_HPP
+#define MATRIX_KERNELS_HPP
+#include "Matrix.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/// The order the matrix operation loops visit the matrix elements
+/// or tiles
+enum LoopOrder
+{
+  COLUMN_MAJOR_LOOP, // outer loop over the columns, as in the buggy version
+  ROW_MAJOR_LOOP     // outer loop over the rows, as in the fixed version
+};
+
+/// kernels work on tiles of 64 x 64 elements by default
+const int DEFAULT_KERNEL_TILE = 64;
+
+
+/** add span
+ * Add two contiguous spans of values, result[i] = a[i] + b[i].
+ *
+ * @param result, a, b The spans.
+ * @param n The number of values in the spans.
+ */
+template <class T>
+inline void addSpan(T* result, const T* a, const T* b, int n)
+{
+  for (int i = 0; i < n; i++)
+  {
+    result[i] = a[i] + b[i];
+  }
+}
+
+inline void addSpan(double* result, const double* a, const double* b, int n)
+{
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 4 <= n; i += 4)
+  {
+    _mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= n; i += 2)
+  {
+    _mm_storeu_pd(result + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+#endif
+  for (; i < n; i++)
+  {
+    result[i] = a[i] + b[i];
+  }
+}
+
+inline void addSpan(float* result, const float* a, const float* b, int n)
+{
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 8 <= n; i += 8)
+  {
+    _mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+  }
+#elif defined(__SSE2__)
+  for (; i + 4 <= n; i += 4)
+  {
+    _mm_storeu_ps(result + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+#endif
+  for (; i < n; i++)
+  {
+    result[i] = a[i] + b[i];
+  }
+}
+
+inline void addSpan(int* result, const int* a, const int* b, int n)
+{
+  int i = 0;
+#if defined(__AVX2__)
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                   _mm256_loadu_si256((const __m256i*)(b + i)));
+    _mm256_storeu_si256((__m256i*)(result + i), sum);
+  }
+#elif defined(__SSE2__)
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+    _mm_storeu_si128((__m128i*)(result + i), sum);
+  }
+#endif
+  for (; i < n; i++)
+  {
+    result[i] = a[i] + b[i];
+  }
+}
+
+
+/** multiply add
+ * Add the product of two values to a result, result += a * b.
+ *
+ * @param result The result to add to.
+ * @param a, b The values to multiply.
+ */
+template <class T>
+inline void multiplyAdd(T& result, T a, T b)
+{
+  result += a * b;
+}
+
+/** multiply add
+ * The int products of matrices of 128 x 128 or more elements, with
+ * their initial values, overflow an int, which is undefined.  So they
+ * are done in unsigned arithmetic, which wraps modulo 2^32 exactly as
+ * the AVX2 instructions do, and the scalar and vector kernels agree.
+ */
+inline void multiplyAdd(int& result, int a, int b)
+{
+  result = static_cast<int>(static_cast<unsigned>(result) + static_cast<unsigned>(a) * static_cast<unsigned>(b));
+}
+
+
+/** multiply add span
+ * Add a multiple of a contiguous span of values to another span,
+ * result[i] += a * b[i], the inner loop of matrix multiplication.
+ *
+ * @param result, b The spans.
+ * @param a The value to multiply b by.
+ * @param n The number of values in the spans.
+ */
+template <class T>
+inline void multiplyAddSpan(T* result, const T* b, T a, int n)
+{
+  for (int i = 0; i < n; i++)
+  {
+    multiplyAdd(result[i], a, b[i]);
+  }
+}
+
+inline void multiplyAddSpan(double* result, const double* b, double a, int n)
+{
+  int i = 0;
+#if defined(__AVX2__)
+  __m256d multiplier = _mm256_set1_pd(a);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m256d product = _mm256_mul_pd(multiplier, _mm256_loadu_pd(b + i));
+    _mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(result + i), product));
+  }
+#elif defined(__SSE2__)
+  __m128d multiplier = _mm_set1_pd(a);
+  for (; i + 2 <= n; i += 2)
+  {
+    __m128d product = _mm_mul_pd(multiplier, _mm_loadu_pd(b + i));
+    _mm_storeu_pd(result + i, _mm_add_pd(_mm_loadu_pd(result + i), product));
+  }
+#endif
+  for (; i < n; i++)
+  {
+    result[i] += a * b[i];
+  }
+}
+
+inline void multiplyAddSpan(float* result, const float* b, float a, int n)
+{
+  int i = 0;
+#if defined(__AVX2__)
+  __m256 multiplier = _mm256_set1_ps(a);
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256 product = _mm256_mul_ps(multiplier, _mm256_loadu_ps(b + i));
+    _mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_loadu_ps(result + i), product));
+  }
+#elif defined(__SSE2__)
+  __m128 multiplier = _mm_set1_ps(a);
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128 product = _mm_mul_ps(multiplier, _mm_loadu_ps(b + i));
+    _mm_storeu_ps(result + i, _mm_add_ps(_mm_loadu_ps(result + i), product));
+  }
+#endif
+  for (; i < n; i++)
+  {
+    result[i] += a * b[i];
+  }
+}
+
+inline void multiplyAddSpan(int* result, const int* b, int a, int n)
+{
+  int i = 0;
+  // SSE2 has no 32 bit multiply that keeps the low half, so only AVX2
+#if defined(__AVX2__)
+  __m256i multiplier = _mm256_set1_epi32(a);
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i product = _mm256_mullo_epi32(multiplier, _mm256_loadu_si256((const __m256i*)(b + i)));
+    __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(result + i)), product);
+    _mm256_storeu_si256((__m256i*)(result + i), sum);
+  }
+#endif
+  for (; i < n; i++)
+  {
+    multiplyAdd(result[i], a, b[i]);
+  }
+}
+
+
+/** tile of step
+ * Find the tile visited at a step of a loop over the tiles of a
+ * matrix, in the indicated loop order.
+ *
+ * @param step The step of the loop over the tiles.
+ * @param numRowTiles, numColTiles The number of rows and columns of tiles.
+ * @param loopOrder The order to visit the tiles in.
+ * @param tileRow, tileCol Returns the row and column of the tile.
+ */
+inline void tileOfStep(int step, int numRowTiles, int numColTiles, LoopOrder loopOrder, int& tileRow, int& tileCol)
+{
+  if (loopOrder == ROW_MAJOR_LOOP)
+  {
+    tileRow = step / numColTiles;
+    tileCol = step % numColTiles;
+  }
+  else
+  {
+    tileCol = step / numRowTiles;
+    tileRow = step % numRowTiles;
+  }
+}
+
+
+/** add kernel
+ * Tiled matrix addition, result = a + b.
+ *
+ * @param result, a, b The matrices, all of the same size.
+ * @param loopOrder The order to visit the tiles in.
+ * @param tileSize The number of rows and columns of the tiles.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void addKernel(Matrix<T, Rows, Cols, Layout>& result, Matrix<T, Rows, Cols, Layout>& a,
+               Matrix<T, Rows, Cols, Layout>& b, LoopOrder loopOrder, int tileSize = DEFAULT_KERNEL_TILE)
+{
+  typedef Matrix<T, Rows, Cols, Layout> MatrixType;
+  int numRows = result.getNumRows();
+  int numCols = result.getNumCols();
+  if (a.getNumRows() != numRows or a.getNumCols() != numCols or b.getNumRows() != numRows or
+      b.getNumCols() != numCols or tileSize < 1)
+  {
+    cerr << "Error: addKernel() matrices must all be the same size" << endl;
+    exit(1);
+  }
+
+  T* resultData = result.getData();
+  const T* aData = a.getData();
+  const T* bData = b.getData();
+  int numRowTiles = (numRows + tileSize - 1) / tileSize;
+  int numColTiles = (numCols + tileSize - 1) / tileSize;
+  for (int step = 0; step < numRowTiles * numColTiles; step++)
+  {
+    int tileRow, tileCol;
+    tileOfStep(step, numRowTiles, numColTiles, loopOrder, tileRow, tileCol);
+    int row = tileRow * tileSize;
+    int col = tileCol * tileSize;
+    int blockRows = min(tileSize, numRows - row);
+    int blockCols = min(tileSize, numCols - col);
+    a.touchBlock(row, col, blockRows, blockCols, false);
+    b.touchBlock(row, col, blockRows, blockCols, false);
+    result.touchBlock(row, col, blockRows, blockCols, true);
+
+    if (Layout::rowsContiguous)
+    {
+      for (int i = row; i < row + blockRows; i++)
+      {
+        long offset = MatrixType::elementOffset(i, col, numRows, numCols);
+        addSpan(resultData + offset, aData + offset, bData + offset, blockCols);
+      }
+    }
+    else if (Layout::colsContiguous)
+    {
+      for (int j = col; j < col + blockCols; j++)
+      {
+        long offset = MatrixType::elementOffset(row, j, numRows, numCols);
+        addSpan(resultData + offset, aData + offset, bData + offset, blockRows);
+      }
+    }
+    else
+    {
+      for (int i = row; i < row + blockRows; i++)
+      {
+        for (int j = col; j < col + blockCols; j++)
+        {
+          long offset = MatrixType::elementOffset(i, j, numRows, numCols);
+          resultData[offset] = aData[offset] + bData[offset];
+        }
+      }
+    }
+  }
+}
+
+
+/** multiply kernel
+ * Tiled matrix multiplication, result = a * b.  The tiles of the
+ * result are visited in the indicated loop order, and each is
+ * accumulated from the products of a row of tiles of a and a column
+ * of tiles of b.  The int products of large matrices wrap modulo
+ * 2^32, see multiplyAdd().
+ *
+ * @param result, a, b The matrices, a is n x m, b is m x p and the
+ *   result is n x p.
+ * @param loopOrder The order to visit the tiles of the result in.
+ * @param tileSize The number of rows and columns of the tiles.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void multiplyKernel(Matrix<T, Rows, Cols, Layout>& result, Matrix<T, Rows, Cols, Layout>& a,
+                    Matrix<T, Rows, Cols, Layout>& b, LoopOrder loopOrder, int tileSize = DEFAULT_KERNEL_TILE)
+{
+  typedef Matrix<T, Rows, Cols, Layout> MatrixType;
+  int n = a.getNumRows();
+  int m = a.getNumCols();
+  int p = b.getNumCols();
+  if (b.getNumRows() != m or result.getNumRows() != n or result.getNumCols() != p or tileSize < 1)
+  {
+    cerr << "Error: multiplyKernel() can not multiply a " << n << " x " << m << " matrix" << endl
+         << "   by a " << b.getNumRows() << " x " << p << " matrix" << endl;
+    exit(1);
+  }
+
+  T* resultData = result.getData();
+  const T* aData = a.getData();
+  const T* bData = b.getData();
+  int numRowTiles = (n + tileSize - 1) / tileSize;
+  int numColTiles = (p + tileSize - 1) / tileSize;
+  for (int step = 0; step < numRowTiles * numColTiles; step++)
+  {
+    int tileRow, tileCol;
+    tileOfStep(step, numRowTiles, numColTiles, loopOrder, tileRow, tileCol);
+    int row = tileRow * tileSize;
+    int col = tileCol * tileSize;
+    int blockRows = min(tileSize, n - row);
+    int blockCols = min(tileSize, p - col);
+
+    result.touchBlock(row, col, blockRows, blockCols, true);
+    for (int i = row; i < row + blockRows; i++)
+    {
+      for (int j = col; j < col + blockCols; j++)
+      {
+        resultData[MatrixType::elementOffset(i, j, n, p)] = T(0);
+      }
+    }
+
+    for (int inner = 0; inner < m; inner += tileSize)
+    {
+      int blockInner = min(tileSize, m - inner);
+      a.touchBlock(row, inner, blockRows, blockInner, false);
+      b.touchBlock(inner, col, blockInner, blockCols, false);
+
+      if (Layout::rowsContiguous)
+      {
+        // each row of the result tile accumulates rows of the b tile
+        for (int i = row; i < row + blockRows; i++)
+        {
+          T* resultRow = resultData + MatrixType::elementOffset(i, col, n, p);
+          for (int k = inner; k < inner + blockInner; k++)
+          {
+            multiplyAddSpan(resultRow, bData + MatrixType::elementOffset(k, col, m, p),
+                            aData[MatrixType::elementOffset(i, k, n, m)], blockCols);
+          }
+        }
+      }
+      else if (Layout::colsContiguous)
+      {
+        // each column of the result tile accumulates columns of the a tile
+        for (int j = col; j < col + blockCols; j++)
+        {
+          T* resultCol = resultData + MatrixType::elementOffset(row, j, n, p);
+          for (int k = inner; k < inner + blockInner; k++)
+          {
+            multiplyAddSpan(resultCol, aData + MatrixType::elementOffset(row, k, n, m),
+                            bData[MatrixType::elementOffset(k, j, m, p)], blockRows);
+          }
+        }
+      }
+      else
+      {
+        for (int i = row; i < row + blockRows; i++)
+        {
+          for (int k = inner; k < inner + blockInner; k++)
+          {
+            T aik = aData[MatrixType::elementOffset(i, k, n, m)];
+            for (int j = col; j < col + blockCols; j++)
+            {
+              multiplyAdd(resultData[MatrixType::elementOffset(i, j, n, p)], aik,
+                          bData[MatrixType::elementOffset(k, j, m, p)]);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+
+/** transpose kernel
+ * Tiled matrix transpose, result = a transposed.  Each tile of a is
+ * copied to the mirrored tile of the result.  The copy is not
+ * vectorized, it is the tiling that keeps both the reads and writes
+ * within a few pages and cache lines.
+ *
+ * @param result, a The matrices, a is n x m and the result is m x n.
+ * @param loopOrder The order to visit the tiles of a in.
+ * @param tileSize The number of rows and columns of the tiles.
+ */
+template <class T, int Rows, int Cols, class Layout>
+void transposeKernel(Matrix<T, Rows, Cols, Layout>& result, Matrix<T, Rows, Cols, Layout>& a, LoopOrder loopOrder,
+                     int tileSize = DEFAULT_KERNEL_TILE)
+{
+  typedef Matrix<T, Rows, Cols, Layout> MatrixType;
+  int n = a.getNumRows();
+  int m = a.getNumCols();
+  if (result.getNumRows() != m or result.getNumCols() != n or tileSize < 1)
+  {
+    cerr << "Error: transposeKernel() can not transpose a " << n << " x " << m << " matrix" << endl
+         << "   into a " << result.getNumRows() << " x " << result.getNumCols() << " matrix" << endl;
+    exit(1);
+  }
+
+  T* resultData = result.getData();
+  const T* aData = a.getData();
+  int numRowTiles = (n + tileSize - 1) / tileSize;
+  int numColTiles = (m + tileSize - 1) / tileSize;
+  for (int step = 0; step < numRowTiles * numColTiles; step++)
+  {
+    int tileRow, tileCol;
+    tileOfStep(step, numRowTiles, numColTiles, loopOrder, tileRow, tileCol);
+    int row = tileRow * tileSize;
+    int col = tileCol * tileSize;
+    int blockRows = min(tileSize, n - row);
+    int blockCols = min(tileSize, m - col);
+    a.touchBlock(row, col, blockRows, blockCols, false);
+    result.touchBlock(col, row, blockCols, blockRows, true);
+
+    for (int i = row; i < row + blockRows; i++)
+    {
+      for (int j = col; j < col + blockCols; j++)
+      {
+        resultData[MatrixType::elementOffset(j, i, m, n)] = aData[MatrixType::elementOffset(i, j, n, m)];
+      }
+    }
+  }
+}
+
+#endif // MATRIX_KERNELS_HPP
@@ -0,0 +1,196 @@
+/** @file PageArena.cpp
+ * @brief A page aligned arena for the storage of matrices.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the page arena.
+ */
+#include "PageArena.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+
+/** page arena constructor
+ * An arena with nothing mapped yet, aligning blocks to the page size
+ * of the machine.
+ *
+ * @param chunkBytes The size of the chunks to map, larger blocks get
+ *   a chunk of their own.
+ */
+PageArena::PageArena(long chunkBytes)
+{
+  this->chunkBytes = chunkBytes;
+  alignment = getSystemPageSize();
+  nextFree = NULL;
+  chunkEnd = NULL;
+  allocations = 0;
+  reuses = 0;
+  bytesInUse = 0;
+  peakBytesInUse = 0;
+}
+
+
+/** page arena destructor
+ * Unmap all of the chunks.  Any blocks still in use are lost.
+ */
+PageArena::~PageArena()
+{
+  for (MappedArray* chunk : chunks)
+  {
+    delete chunk;
+  }
+}
+
+
+/** set alignment
+ * Align the blocks handed out from now on to the indicated alignment,
+ * or to the page size of the machine if that is larger.  Released
+ * blocks may not have the new alignment, so they are not handed out
+ * again if it changes.
+ *
+ * @param alignment The alignment, a power of two.
+ */
+void PageArena::setAlignment(long alignment)
+{
+  if (alignment < 1 or (alignment & (alignment - 1)) != 0)
+  {
+    cerr << "Error: PageArena::setAlignment() alignment " << alignment << " is not a power of two" << endl;
+    exit(1);
+  }
+
+  alignment = max(alignment, getSystemPageSize());
+  if (alignment == this->alignment)
+  {
+    return;
+  }
+
+  this->alignment = alignment;
+  freeBlocks.clear();
+  if (nextFree != NULL)
+  {
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(nextFree) + alignment - 1) & ~uintptr_t(alignment - 1);
+    nextFree = min(reinterpret_cast<char*>(aligned), chunkEnd);
+  }
+}
+
+
+/** get alignment
+ * @returns long The alignment of the blocks handed out.
+ */
+long PageArena::getAlignment() const
+{
+  return alignment;
+}
+
+
+/** block size
+ * @param numBytes The number of bytes asked for.
+ *
+ * @returns long The size of the block holding them, a whole number
+ *   of aligned pages.
+ */
+long PageArena::blockSize(long numBytes) const
+{
+  return max(1L, (numBytes + alignment - 1) / alignment) * alignment;
+}
+
+
+/** map chunk
+ * Map a new chunk to hand out blocks from, large enough for a block
+ * of the indicated size.  What is left of the previous chunk is not
+ * used.
+ *
+ * @param numBytes The size of the block the chunk is needed for.
+ */
+void PageArena::mapChunk(long numBytes)
+{
+  // mmap only aligns to the page size of the machine, so map enough
+  // extra to start at the alignment
+  long mapBytes = max(chunkBytes, numBytes) + alignment - getSystemPageSize();
+  MappedArray* chunk = new MappedArray(mapBytes);
+  chunks.push_back(chunk);
+
+  char* start = static_cast<char*>(chunk->getAddress());
+  uintptr_t aligned = (reinterpret_cast<uintptr_t>(start) + alignment - 1) & ~uintptr_t(alignment - 1);
+  nextFree = reinterpret_cast<char*>(aligned);
+  chunkEnd = start + mapBytes;
+}
+
+
+/** allocate
+ * Hand out a block of at least the indicated size, starting on an
+ * aligned page.  A released block of the same size is handed out
+ * again if there is one.  The contents of a reused block are what
+ * was left in it, a new block is zero filled.
+ *
+ * @param numBytes The size of the block in bytes.
+ *
+ * @returns void* The start of the block.
+ */
+void* PageArena::allocate(long numBytes)
+{
+  long size = blockSize(numBytes);
+  allocations++;
+  bytesInUse += size;
+  peakBytesInUse = max(peakBytesInUse, bytesInUse);
+
+  map<long, vector<void*>>::iterator it = freeBlocks.find(size);
+  if (it != freeBlocks.end() and not it->second.empty())
+  {
+    void* block = it->second.back();
+    it->second.pop_back();
+    reuses++;
+    return block;
+  }
+
+  if (chunkEnd - nextFree < size)
+  {
+    mapChunk(size);
+  }
+  void* block = nextFree;
+  nextFree += size;
+  return block;
+}
+
+
+/** release
+ * Give a block back to the arena, to be handed out again.
+ *
+ * @param block The start of the block, as returned by allocate().
+ * @param numBytes The size the block was allocated with.
+ */
+void PageArena::release(void* block, long numBytes)
+{
+  long size = blockSize(numBytes);
+  bytesInUse -= size;
+  freeBlocks[size].push_back(block);
+}
+
+
+/** display results
+ * Display how much memory the arena has mapped, and how often it
+ * reused released blocks.
+ *
+ * @param out The stream to display the results on.
+ */
+void PageArena::displayResults(ostream& out) const
+{
+  long mappedBytes = 0;
+  for (MappedArray* chunk : chunks)
+  {
+    mappedBytes += chunk->getNumBytes();
+  }
+
+  out << "<PageArena> matrix storage" << "\n"
+      << "    Alignment: " << alignment << " bytes" << "\n"
+      << "    Chunks mapped: " << chunks.size() << " in " << mappedBytes << " bytes" << "\n"
+      << "    Blocks allocated: " << allocations << " reused: " << reuses << "\n"
+      << "    Bytes in use: " << bytesInUse << " peak: " << peakBytesInUse << "\n";
+}
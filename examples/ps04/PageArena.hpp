@@ -0,0 +1,72 @@
+/** @file PageArena.hpp
+ * @brief A page aligned arena for the storage of matrices.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * An arena handing out page aligned blocks of memory, carved out of
+ * large chunks mapped with mmap.  Blocks that are released are kept
+ * by their size and handed out again, so matrices created and
+ * destroyed run after run of a simulation reuse the same memory
+ * without going back to malloc or the operating system.  Because
+ * every block starts on a page boundary, the pages of the paging
+ * simulation line up with the real pages of the matrices.
+ */
+#ifndef PAGE_ARENA_HPP
+#define PAGE_ARENA_HPP
+#include "MappedMemory.hpp"
+#include <map>
+#include <ostream>
+#include <vector>
+
+using namespace std;
+
+/// the size of the chunks of memory the arena maps at a time
+const long DEFAULT_ARENA_CHUNK_BYTES = 16L * 1024 * 1024;
+
+/** @class PageArena
+ * @brief Page aligned blocks of memory, reused once released
+ *
+ * Blocks are a whole number of aligned pages.  The alignment is at
+ * least the page size of the machine, and can be raised to a larger
+ * power of two, for example the simulated page size.  The memory of
+ * the arena is only unmapped when the arena is destroyed.  The arena
+ * is not thread safe.
+ */
+class PageArena
+{
+private:
+  long chunkBytes;
+  long alignment;
+  vector<MappedArray*> chunks;
+
+  /// the part of the newest chunk not handed out yet
+  char* nextFree;
+  char* chunkEnd;
+
+  /// released blocks, by their size, to be handed out again
+  map<long, vector<void*>> freeBlocks;
+
+  long allocations;
+  long reuses;
+  long bytesInUse;
+  long peakBytesInUse;
+
+  long blockSize(long numBytes) const;
+  void mapChunk(long numBytes);
+
+public:
+  PageArena(long chunkBytes = DEFAULT_ARENA_CHUNK_BYTES);
+  ~PageArena();
+  PageArena(const PageArena&) = delete;
+  PageArena& operator=(const PageArena&) = delete;
+  void setAlignment(long alignment);
+  long getAlignment() const;
+  void* allocate(long numBytes);
+  void release(void* block, long numBytes);
+  void displayResults(ostream& out) const;
+};
+
+#endif // PAGE_ARENA_HPP
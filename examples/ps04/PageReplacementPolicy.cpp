@@ -0,0 +1,604 @@
+/** @file PageReplacementPolicy.cpp
+ * @brief Page replacement policies for the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the FIFO, LRU, Clock and OPT page replacement
+ * policies used by the DynamicPagingSimulator.
+ */
+#include "PageReplacementPolicy.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+
+/// marks the end of the LRU list
+const int NO_LINK = -1;
+
+/** policy destructor
+ * Virtual destructor so policies can be deleted through a base
+ * class pointer.
+ */
+PageReplacementPolicy::~PageReplacementPolicy()
+{
+}
+
+
+/** default constructor
+ * Construct an LRU policy managing no frames, reset() must be called
+ * before use.
+ */
+LruPolicy::LruPolicy()
+{
+  head = NO_LINK;
+  tail = NO_LINK;
+}
+
+
+/** policy name
+ * @returns string The name of this policy.
+ */
+string LruPolicy::getName() const
+{
+  return "LRU";
+}
+
+
+/** reset policy
+ * Start over with an empty list of frames.
+ *
+ * @param numFrames The number of frames being managed.
+ */
+void LruPolicy::reset(int numFrames)
+{
+  prev.assign(numFrames, NO_LINK);
+  next.assign(numFrames, NO_LINK);
+  head = NO_LINK;
+  tail = NO_LINK;
+}
+
+
+/** unlink frame
+ * Remove a frame from the list.
+ *
+ * @param frame The frame to remove, it must be on the list.
+ */
+void LruPolicy::unlink(int frame)
+{
+  if (prev[frame] == NO_LINK)
+  {
+    head = next[frame];
+  }
+  else
+  {
+    next[prev[frame]] = next[frame];
+  }
+
+  if (next[frame] == NO_LINK)
+  {
+    tail = prev[frame];
+  }
+  else
+  {
+    prev[next[frame]] = prev[frame];
+  }
+
+  prev[frame] = NO_LINK;
+  next[frame] = NO_LINK;
+}
+
+
+/** push front
+ * Put a frame at the front (most recently used end) of the list.
+ *
+ * @param frame The frame to insert, it must not be on the list.
+ */
+void LruPolicy::pushFront(int frame)
+{
+  prev[frame] = NO_LINK;
+  next[frame] = head;
+  if (head == NO_LINK)
+  {
+    tail = frame;
+  }
+  else
+  {
+    prev[head] = frame;
+  }
+  head = frame;
+}
+
+
+/** push back
+ * Put a frame at the back (least recently used end) of the list.
+ *
+ * @param frame The frame to insert, it must not be on the list.
+ */
+void LruPolicy::pushBack(int frame)
+{
+  next[frame] = NO_LINK;
+  prev[frame] = tail;
+  if (tail == NO_LINK)
+  {
+    head = frame;
+  }
+  else
+  {
+    next[tail] = frame;
+  }
+  tail = frame;
+}
+
+
+/** page loaded
+ * A newly loaded page is the most recently used page.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void LruPolicy::pageLoaded(int frame)
+{
+  pushFront(frame);
+}
+
+
+/** page prefetched
+ * A prefetched page has not been used yet, so it is the least
+ * recently used page until it is referenced.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void LruPolicy::pagePrefetched(int frame)
+{
+  pushBack(frame);
+}
+
+
+/** page referenced
+ * Move the referenced frame to the front of the list.
+ *
+ * @param frame The frame that was referenced.
+ */
+void LruPolicy::pageReferenced(int frame)
+{
+  if (frame != head)
+  {
+    unlink(frame);
+    pushFront(frame);
+  }
+}
+
+
+/** page rereferenced
+ * The frame ends up at the front of the list however many times it
+ * is referenced, where the first reference of the run put it, as
+ * pages prefetched since then go to the back.
+ *
+ * @param frame The frame that was referenced.
+ * @param numReferences The number of times it was referenced again.
+ */
+void LruPolicy::pageRereferenced(int frame, long numReferences)
+{
+  pageReferenced(frame);
+}
+
+
+/** select victim
+ * The victim is the least recently used frame at the back of the
+ * list, or the frame before it if it is pinned.
+ *
+ * @param pinnedFrame A frame that must not be replaced, or
+ *   NO_PINNED_FRAME.
+ *
+ * @returns int The frame to be replaced.
+ */
+int LruPolicy::selectVictim(int pinnedFrame)
+{
+  int frame = (tail == pinnedFrame) ? prev[tail] : tail;
+  unlink(frame);
+  return frame;
+}
+
+
+/** page freed
+ * Remove the freed frame from the list.
+ *
+ * @param frame The frame that is now free.
+ */
+void LruPolicy::pageFreed(int frame)
+{
+  unlink(frame);
+}
+
+
+/** policy name
+ * @returns string The name of this policy.
+ */
+string FifoPolicy::getName() const
+{
+  return "FIFO";
+}
+
+
+/** reset policy
+ * Start over with no pages loaded.
+ *
+ * @param numFrames The number of frames being managed.
+ */
+void FifoPolicy::reset(int numFrames)
+{
+  LruPolicy::reset(numFrames);
+  prefetched.assign(numFrames, 0);
+}
+
+
+/** page loaded
+ * A newly loaded page goes to the front of the queue, the victim is
+ * taken from the back.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void FifoPolicy::pageLoaded(int frame)
+{
+  pushFront(frame);
+  prefetched[frame] = 0;
+}
+
+
+/** page prefetched
+ * A prefetched page goes to the back of the queue, to be replaced
+ * first unless it is referenced before then.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void FifoPolicy::pagePrefetched(int frame)
+{
+  pushBack(frame);
+  prefetched[frame] = 1;
+}
+
+
+/** page referenced
+ * References do not change the FIFO order, except that the first
+ * reference to a prefetched page moves it to the front of the queue,
+ * as if it was loaded then.
+ *
+ * @param frame The frame that was referenced.
+ */
+void FifoPolicy::pageReferenced(int frame)
+{
+  if (prefetched[frame])
+  {
+    unlink(frame);
+    pageLoaded(frame);
+  }
+}
+
+
+/** page rereferenced
+ * References do not change the FIFO order, the first reference of
+ * the run already moved a prefetched page to the front of the queue.
+ *
+ * @param frame The frame that was referenced.
+ * @param numReferences The number of times it was referenced again.
+ */
+void FifoPolicy::pageRereferenced(int frame, long numReferences)
+{
+}
+
+
+/** default constructor
+ * Construct a clock policy managing no frames, reset() must be called
+ * before use.
+ */
+ClockPolicy::ClockPolicy()
+{
+  hand = 0;
+}
+
+
+/** policy name
+ * @returns string The name of this policy.
+ */
+string ClockPolicy::getName() const
+{
+  return "Clock";
+}
+
+
+/** reset policy
+ * Start over with all use bits clear and the hand at frame 0.
+ *
+ * @param numFrames The number of frames being managed.
+ */
+void ClockPolicy::reset(int numFrames)
+{
+  useBit.assign(numFrames, 0);
+  hand = 0;
+}
+
+
+/** page loaded
+ * A newly loaded page has its use bit set.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void ClockPolicy::pageLoaded(int frame)
+{
+  useBit[frame] = 1;
+}
+
+
+/** page prefetched
+ * A prefetched page has its use bit clear, so the hand replaces it
+ * unless it is referenced before the hand gets to it.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void ClockPolicy::pagePrefetched(int frame)
+{
+  useBit[frame] = 0;
+}
+
+
+/** page referenced
+ * Set the use bit of the referenced frame.
+ *
+ * @param frame The frame that was referenced.
+ */
+void ClockPolicy::pageReferenced(int frame)
+{
+  useBit[frame] = 1;
+}
+
+
+/** page rereferenced
+ * The use bit of the frame ends up set however many times it is
+ * referenced.  It is set again, as the hand may have cleared it
+ * replacing frames for pages prefetched since it was first
+ * referenced.
+ *
+ * @param frame The frame that was referenced.
+ * @param numReferences The number of times it was referenced again.
+ */
+void ClockPolicy::pageRereferenced(int frame, long numReferences)
+{
+  pageReferenced(frame);
+}
+
+
+/** select victim
+ * Sweep the clock hand around the ring giving every frame with its
+ * use bit set a second chance, until a frame with a clear use bit is
+ * found.  The hand passes over a pinned frame, leaving its use bit
+ * as it is.  The hand is left pointing just past the victim.
+ *
+ * @param pinnedFrame A frame that must not be replaced, or
+ *   NO_PINNED_FRAME.
+ *
+ * @returns int The frame to be replaced.
+ */
+int ClockPolicy::selectVictim(int pinnedFrame)
+{
+  int numFrames = useBit.size();
+  while (hand == pinnedFrame or useBit[hand])
+  {
+    if (hand != pinnedFrame)
+    {
+      useBit[hand] = 0;
+    }
+    hand = (hand + 1) % numFrames;
+  }
+
+  int frame = hand;
+  hand = (hand + 1) % numFrames;
+  return frame;
+}
+
+
+/** page freed
+ * Clear the use bit of the freed frame.  The hand never reaches a
+ * free frame, since victims are only selected when no frame is free.
+ *
+ * @param frame The frame that is now free.
+ */
+void ClockPolicy::pageFreed(int frame)
+{
+  useBit[frame] = 0;
+}
+
+
+/** constructor
+ * Construct an OPT policy for the given reference string.  We make a
+ * single backwards pass over the reference string remembering where
+ * each page was next seen, which gives the next use of every
+ * reference.
+ *
+ * @param referenceString The complete sequence of page references the
+ *   simulation will make.
+ */
+OptimalPolicy::OptimalPolicy(const vector<PageReference>& referenceString)
+{
+  long numReferences = referenceString.size();
+  unordered_map<long long, long> nextSeen;
+
+  nextUse.resize(numReferences);
+  for (long position = numReferences - 1; position >= 0; position--)
+  {
+    const PageReference& reference = referenceString[position];
+    long long key = ((long long)reference.processId << 32) | (unsigned int)reference.pageNumber;
+
+    unordered_map<long long, long>::iterator it = nextSeen.find(key);
+    nextUse[position] = (it == nextSeen.end()) ? numReferences : it->second;
+    nextSeen[key] = position;
+  }
+
+  currentReference = 0;
+}
+
+
+/** policy name
+ * @returns string The name of this policy.
+ */
+string OptimalPolicy::getName() const
+{
+  return "OPT";
+}
+
+
+/** reset policy
+ * Start over from the beginning of the reference string.
+ *
+ * @param numFrames The number of frames being managed.
+ */
+void OptimalPolicy::reset(int numFrames)
+{
+  frameNextUse.assign(numFrames, 0);
+  framesByNextUse.clear();
+  currentReference = 0;
+}
+
+
+/** update frame
+ * The page in the frame has just been referenced by the current
+ * reference, so its next use is now the next use of that reference.
+ * Then move on to the next reference of the reference string.
+ *
+ * @param frame The frame that was referenced.
+ */
+void OptimalPolicy::updateFrame(int frame)
+{
+  long numReferences = nextUse.size();
+  long frameUse = (currentReference < numReferences) ? nextUse[currentReference] : numReferences;
+
+  framesByNextUse.erase(make_pair(frameNextUse[frame], frame));
+  frameNextUse[frame] = frameUse;
+  framesByNextUse.insert(make_pair(frameUse, frame));
+
+  currentReference++;
+}
+
+
+/** page loaded
+ * Record the next use of the newly loaded page.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void OptimalPolicy::pageLoaded(int frame)
+{
+  updateFrame(frame);
+}
+
+
+/** page prefetched
+ * Prefetches are not part of the reference string, so OPT can not be
+ * used with prefetching.  Should a page be prefetched anyway, it is
+ * taken to never be used, and is replaced first.  The current
+ * reference does not move on, a prefetch is not a reference.
+ *
+ * @param frame The frame the page was loaded into.
+ */
+void OptimalPolicy::pagePrefetched(int frame)
+{
+  long numReferences = nextUse.size();
+  framesByNextUse.erase(make_pair(frameNextUse[frame], frame));
+  frameNextUse[frame] = numReferences;
+  framesByNextUse.insert(make_pair(numReferences, frame));
+}
+
+
+/** page referenced
+ * Record the next use of the referenced page.
+ *
+ * @param frame The frame that was referenced.
+ */
+void OptimalPolicy::pageReferenced(int frame)
+{
+  updateFrame(frame);
+}
+
+
+/** page rereferenced
+ * Each reference of the run is the next use of the one before it,
+ * so only the next use of the last reference of the run matters.
+ * Skip to it in the reference string, and record it.
+ *
+ * @param frame The frame that was referenced.
+ * @param numReferences The number of times it was referenced again.
+ */
+void OptimalPolicy::pageRereferenced(int frame, long numReferences)
+{
+  currentReference += numReferences - 1;
+  updateFrame(frame);
+}
+
+
+/** select victim
+ * The victim is the frame whose page is next used furthest in the
+ * future, which is the last frame in our ordered set, or the frame
+ * before it in the set if it is pinned.
+ *
+ * @param pinnedFrame A frame that must not be replaced, or
+ *   NO_PINNED_FRAME.
+ *
+ * @returns int The frame to be replaced.
+ */
+int OptimalPolicy::selectVictim(int pinnedFrame)
+{
+  set<pair<long, int>>::iterator victim = --framesByNextUse.end();
+  if (victim->second == pinnedFrame)
+  {
+    --victim;
+  }
+  int frame = victim->second;
+  framesByNextUse.erase(victim);
+  return frame;
+}
+
+
+/** page freed
+ * Remove the freed frame from the frames ordered by next use.
+ *
+ * @param frame The frame that is now free.
+ */
+void OptimalPolicy::pageFreed(int frame)
+{
+  framesByNextUse.erase(make_pair(frameNextUse[frame], frame));
+}
+
+
+/** make replacement policy
+ * Factory to create a page replacement policy by name.
+ *
+ * @param policyName One of fifo, lru, clock or opt.
+ * @param referenceString The reference string the simulation will
+ *   make, only used by the opt policy.
+ *
+ * @returns PageReplacementPolicy* A newly allocated policy, owned by
+ *   the caller, or NULL if the policy name is not known.
+ */
+PageReplacementPolicy* makeReplacementPolicy(const string& policyName, const vector<PageReference>& referenceString)
+{
+  if (policyName == "fifo")
+  {
+    return new FifoPolicy();
+  }
+  else if (policyName == "lru")
+  {
+    return new LruPolicy();
+  }
+  else if (policyName == "clock")
+  {
+    return new ClockPolicy();
+  }
+  else if (policyName == "opt")
+  {
+    return new OptimalPolicy(referenceString);
+  }
+  else
+  {
+    return NULL;
+  }
+}
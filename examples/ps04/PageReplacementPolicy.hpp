@@ -0,0 +1,204 @@
+/** @file PageReplacementPolicy.hpp
+ * @brief Page replacement policies for the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Page replacement policies used by the DynamicPagingSimulator to
+ * choose a victim frame when a page fault occurs and there are no
+ * free frames left.  The simulator tells the policy about every page
+ * that is loaded into a frame and every reference to a resident page,
+ * and asks the policy for a victim frame when it needs one.  Policies
+ * only ever deal with frame numbers, the simulator keeps track of
+ * which page of which process is held in each frame.
+ */
+#ifndef PAGE_REPLACEMENT_POLICY_HPP
+#define PAGE_REPLACEMENT_POLICY_HPP
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** Page reference
+ * A single reference to a virtual page made by a process.  A
+ * sequence of these is a reference string.
+ */
+struct PageReference
+{
+  /// the id of the process (matrix) making the reference
+  int processId;
+  /// the virtual page number being referenced
+  int pageNumber;
+};
+
+/// indicate no frame is pinned when selecting a victim
+const int NO_PINNED_FRAME = -1;
+
+/** @class PageReplacementPolicy
+ * @brief Abstract page replacement policy
+ *
+ * The interface all page replacement policies implement.  The
+ * simulator guarantees that the frame passed to pageLoaded() or
+ * pagePrefetched() is either a never used frame, a frame passed to
+ * pageFreed(), or the frame just returned by selectVictim(), and that
+ * pageReferenced(), pageRereferenced() and pageFreed() are only called
+ * for frames that currently hold a page.  A frame pinned when
+ * selecting a victim holds a page, and some other frame also holds a
+ * page.
+ */
+class PageReplacementPolicy
+{
+public:
+  virtual ~PageReplacementPolicy();
+
+  /// @brief The name of the policy, for reporting results
+  virtual string getName() const = 0;
+  /// @brief Start over with the indicated number of empty frames
+  virtual void reset(int numFrames) = 0;
+  /// @brief A page has been loaded into the indicated frame
+  virtual void pageLoaded(int frame) = 0;
+  /// @brief A prefetched page, not referenced yet, has been loaded into the indicated frame
+  virtual void pagePrefetched(int frame) = 0;
+  /// @brief The page in the indicated frame was referenced (a hit)
+  virtual void pageReferenced(int frame) = 0;
+  /// @brief The page in the indicated frame, just referenced, was referenced again numReferences times in a row
+  virtual void pageRereferenced(int frame, long numReferences) = 0;
+  /// @brief Choose and remove a frame whose page will be replaced, other than the pinned frame
+  virtual int selectVictim(int pinnedFrame) = 0;
+  /// @brief The page in the indicated frame was removed, the frame is free
+  virtual void pageFreed(int frame) = 0;
+};
+
+/** @class LruPolicy
+ * @brief Least recently used replacement
+ *
+ * The page that has gone the longest without being referenced is
+ * replaced.  The frames are kept on an intrusive doubly linked list
+ * ordered from most to least recently used, where the links are
+ * simply arrays indexed by frame number.  So moving a frame to the
+ * front on a reference, and taking the victim from the back, are
+ * both O(1).
+ */
+class LruPolicy : public PageReplacementPolicy
+{
+protected:
+  vector<int> prev;
+  vector<int> next;
+  /// most recently used frame
+  int head;
+  /// least recently used frame
+  int tail;
+
+  void unlink(int frame);
+  void pushFront(int frame);
+  void pushBack(int frame);
+
+public:
+  LruPolicy();
+  string getName() const;
+  void reset(int numFrames);
+  void pageLoaded(int frame);
+  void pagePrefetched(int frame);
+  void pageReferenced(int frame);
+  void pageRereferenced(int frame, long numReferences);
+  int selectVictim(int pinnedFrame);
+  void pageFreed(int frame);
+};
+
+/** @class FifoPolicy
+ * @brief First in first out replacement
+ *
+ * The page that has been resident the longest is replaced, no
+ * matter how recently it was referenced.  A prefetched page only
+ * joins the queue when it is first referenced, until then it is the
+ * first to be replaced.  The queue is the intrusive list of LRU, in
+ * load order instead of use order, so freeing a frame is O(1) too.
+ */
+class FifoPolicy : public LruPolicy
+{
+private:
+  /// frames holding a prefetched page that was not referenced yet
+  vector<char> prefetched;
+
+public:
+  string getName() const;
+  void reset(int numFrames);
+  void pageLoaded(int frame);
+  void pagePrefetched(int frame);
+  void pageReferenced(int frame);
+  void pageRereferenced(int frame, long numReferences);
+};
+
+/** @class ClockPolicy
+ * @brief Second chance (clock) replacement
+ *
+ * The frames form a ring with a use bit for each frame, which is set
+ * whenever the page in the frame is referenced.  To find a victim the
+ * clock hand sweeps the ring, clearing set use bits, and stops at the
+ * first frame whose use bit is already clear.  A reference is O(1),
+ * and finding a victim is amortized O(1) since each bit cleared by
+ * the hand had to be set by an earlier reference.
+ */
+class ClockPolicy : public PageReplacementPolicy
+{
+private:
+  vector<char> useBit;
+  int hand;
+
+public:
+  ClockPolicy();
+  string getName() const;
+  void reset(int numFrames);
+  void pageLoaded(int frame);
+  void pagePrefetched(int frame);
+  void pageReferenced(int frame);
+  void pageRereferenced(int frame, long numReferences);
+  int selectVictim(int pinnedFrame);
+  void pageFreed(int frame);
+};
+
+/** @class OptimalPolicy
+ * @brief Belady's optimal (OPT) replacement
+ *
+ * The page whose next use is furthest in the future is replaced.
+ * This needs the complete reference string in advance, so it can
+ * only be used when the references a simulation will make are known,
+ * and the simulation must then make exactly those references in
+ * order.  The time of the next use of every reference is computed
+ * once up front, and the resident frames are kept in a set ordered by
+ * their next use, so each reference costs O(log frames).
+ */
+class OptimalPolicy : public PageReplacementPolicy
+{
+private:
+  /// for each position in the reference string, the position of the
+  /// next reference to the same page, or the length of the string if
+  /// the page is never referenced again
+  vector<long> nextUse;
+  /// position in the reference string of the reference being simulated
+  long currentReference;
+  /// the next use of the page in each frame
+  vector<long> frameNextUse;
+  /// resident frames ordered by the next use of their page
+  set<pair<long, int>> framesByNextUse;
+
+  void updateFrame(int frame);
+
+public:
+  OptimalPolicy(const vector<PageReference>& referenceString);
+  string getName() const;
+  void reset(int numFrames);
+  void pageLoaded(int frame);
+  void pagePrefetched(int frame);
+  void pageReferenced(int frame);
+  void pageRereferenced(int frame, long numReferences);
+  int selectVictim(int pinnedFrame);
+  void pageFreed(int frame);
+};
+
+PageReplacementPolicy* makeReplacementPolicy(const string& policyName, const vector<PageReference>& referenceString);
+
+#endif // PAGE_REPLACEMENT_POLICY_HPP
@@ -0,0 +1,245 @@
+/** @file Prefetcher.cpp
+ * @brief Page prefetchers for the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the page prefetchers.
+ */
+#include "Prefetcher.hpp"
+#include <cstdlib>
+
+using namespace std;
+
+/// the last page of a process that has not triggered a prefetcher yet
+const int NO_LAST_PAGE = -1;
+/// the process of a stream slot that is not tracking a stream
+const int NO_STREAM_PROCESS = -1;
+/// how far, in pages, a trigger may be from the end of a stream and
+/// still continue the stream
+const int STREAM_WINDOW = 4;
+
+
+/** prefetcher destructor
+ * Virtual destructor so prefetchers can be deleted through a base
+ * class pointer.
+ */
+Prefetcher::~Prefetcher()
+{
+}
+
+
+/** sequential prefetcher constructor
+ * @param degree The number of pages to prefetch on each trigger.
+ */
+SequentialPrefetcher::SequentialPrefetcher(int degree)
+{
+  this->degree = degree;
+}
+
+
+/** prefetcher name
+ * @returns string The name of the prefetcher.
+ */
+string SequentialPrefetcher::getName() const
+{
+  return "sequential";
+}
+
+
+/** reset prefetcher
+ * Nothing is remembered between triggers.
+ */
+void SequentialPrefetcher::reset()
+{
+}
+
+
+/** trigger
+ * Prefetch the pages following the page that missed.
+ *
+ * @param processId The process that missed.
+ * @param pageNumber The page that missed.
+ * @param prefetchPages The pages to prefetch are added to this.
+ */
+void SequentialPrefetcher::trigger(int processId, int pageNumber, vector<int>& prefetchPages)
+{
+  for (int ahead = 1; ahead <= degree; ahead++)
+  {
+    prefetchPages.push_back(pageNumber + ahead);
+  }
+}
+
+
+/** stride prefetcher constructor
+ * @param degree The number of strides ahead to prefetch.
+ */
+StridePrefetcher::StridePrefetcher(int degree)
+{
+  this->degree = degree;
+}
+
+
+/** prefetcher name
+ * @returns string The name of the prefetcher.
+ */
+string StridePrefetcher::getName() const
+{
+  return "stride";
+}
+
+
+/** reset prefetcher
+ * Forget the strides of all processes.
+ */
+void StridePrefetcher::reset()
+{
+  processes.clear();
+}
+
+
+/** trigger
+ * Update the stride of the process, and if it is the same as the
+ * previous stride prefetch along it.
+ *
+ * @param processId The process that missed.
+ * @param pageNumber The page that missed.
+ * @param prefetchPages The pages to prefetch are added to this.
+ */
+void StridePrefetcher::trigger(int processId, int pageNumber, vector<int>& prefetchPages)
+{
+  if (processId >= int(processes.size()))
+  {
+    ProcessStride noStride = {NO_LAST_PAGE, 0};
+    processes.resize(processId + 1, noStride);
+  }
+
+  ProcessStride& process = processes[processId];
+  if (process.lastPage != NO_LAST_PAGE)
+  {
+    int stride = pageNumber - process.lastPage;
+    if (stride != 0 and stride == process.stride)
+    {
+      for (int ahead = 1; ahead <= degree; ahead++)
+      {
+        prefetchPages.push_back(pageNumber + ahead * stride);
+      }
+    }
+    process.stride = stride;
+  }
+  process.lastPage = pageNumber;
+}
+
+
+/** stream prefetcher constructor
+ * @param degree The number of pages to prefetch ahead of a stream.
+ * @param numStreams The number of streams to track at once.
+ */
+StreamPrefetcher::StreamPrefetcher(int degree, int numStreams)
+{
+  this->degree = degree;
+  streams.resize(numStreams);
+  reset();
+}
+
+
+/** prefetcher name
+ * @returns string The name of the prefetcher.
+ */
+string StreamPrefetcher::getName() const
+{
+  return "stream";
+}
+
+
+/** reset prefetcher
+ * Forget all of the streams.
+ */
+void StreamPrefetcher::reset()
+{
+  Stream noStream = {NO_STREAM_PROCESS, NO_LAST_PAGE, 0, 0};
+  streams.assign(streams.size(), noStream);
+  time = 0;
+}
+
+
+/** trigger
+ * Continue the stream the page that missed belongs to, or start a new
+ * stream, and prefetch ahead of the stream once it is established.
+ *
+ * @param processId The process that missed.
+ * @param pageNumber The page that missed.
+ * @param prefetchPages The pages to prefetch are added to this.
+ */
+void StreamPrefetcher::trigger(int processId, int pageNumber, vector<int>& prefetchPages)
+{
+  time++;
+
+  // find the stream this continues, which it does if it is a little
+  // way past the last page of the stream, in the direction of the
+  // stream if it has one yet
+  Stream* stream = NULL;
+  Stream* leastRecentlyUsed = &streams[0];
+  for (Stream& candidate : streams)
+  {
+    int distance = pageNumber - candidate.lastPage;
+    bool continues = candidate.processId == processId and distance != 0 and abs(distance) <= STREAM_WINDOW and
+                     (candidate.direction == 0 or (distance > 0) == (candidate.direction > 0));
+    if (continues)
+    {
+      stream = &candidate;
+      break;
+    }
+    if (candidate.lastUsed < leastRecentlyUsed->lastUsed)
+    {
+      leastRecentlyUsed = &candidate;
+    }
+  }
+
+  if (stream == NULL)
+  {
+    Stream newStream = {processId, pageNumber, 0, time};
+    *leastRecentlyUsed = newStream;
+    return;
+  }
+
+  stream->direction = (pageNumber > stream->lastPage) ? 1 : -1;
+  stream->lastPage = pageNumber;
+  stream->lastUsed = time;
+  for (int ahead = 1; ahead <= degree; ahead++)
+  {
+    prefetchPages.push_back(pageNumber + ahead * stream->direction);
+  }
+}
+
+
+/** make prefetcher
+ * Factory to create a prefetcher by name.
+ *
+ * @param prefetcherName One of sequential, stride or stream.
+ * @param degree The number of pages each trigger prefetches.
+ *
+ * @returns Prefetcher* A newly allocated prefetcher, owned by the
+ *   caller, or NULL if the prefetcher name is not known.
+ */
+Prefetcher* makePrefetcher(const string& prefetcherName, int degree)
+{
+  if (prefetcherName == "sequential")
+  {
+    return new SequentialPrefetcher(degree);
+  }
+  else if (prefetcherName == "stride")
+  {
+    return new StridePrefetcher(degree);
+  }
+  else if (prefetcherName == "stream")
+  {
+    return new StreamPrefetcher(degree);
+  }
+  else
+  {
+    return NULL;
+  }
+}
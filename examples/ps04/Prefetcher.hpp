@@ -0,0 +1,132 @@
+/** @file Prefetcher.hpp
+ * @brief Page prefetchers for the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Prefetchers used by the DynamicPagingSimulator to read pages in
+ * before they are referenced, as operating system read-ahead does.
+ * The simulator triggers the prefetcher on every page fault, and on
+ * the first reference to a page that was prefetched, which is a fault
+ * the prefetch saved, and the prefetcher answers with the pages it
+ * predicts will be referenced next.  The simulator loads the pages
+ * that are not already present and keeps count of which prefetches
+ * turned out to be useful.
+ */
+#ifndef PREFETCHER_HPP
+#define PREFETCHER_HPP
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// prefetchers predict 2 pages ahead by default
+const int DEFAULT_PREFETCH_DEGREE = 2;
+/// the number of streams tracked by the stream prefetcher
+const int DEFAULT_NUM_STREAMS = 8;
+
+/** @class Prefetcher
+ * @brief Abstract page prefetcher
+ *
+ * The interface all prefetchers implement.  The pages a prefetcher
+ * predicts may be outside of the address space of the process, or
+ * already present, the simulator ignores those.
+ */
+class Prefetcher
+{
+public:
+  virtual ~Prefetcher();
+
+  /// @brief The name of the prefetcher, for reporting results
+  virtual string getName() const = 0;
+  /// @brief Start over, forgetting all past references
+  virtual void reset() = 0;
+  /// @brief A process missed on a page, add the pages to prefetch
+  virtual void trigger(int processId, int pageNumber, vector<int>& prefetchPages) = 0;
+};
+
+/** @class SequentialPrefetcher
+ * @brief Next N pages read-ahead
+ *
+ * Every trigger prefetches the next degree pages after the page,
+ * the simplest read-ahead.
+ */
+class SequentialPrefetcher : public Prefetcher
+{
+private:
+  int degree;
+
+public:
+  SequentialPrefetcher(int degree = DEFAULT_PREFETCH_DEGREE);
+  string getName() const;
+  void reset();
+  void trigger(int processId, int pageNumber, vector<int>& prefetchPages);
+};
+
+/** @class StridePrefetcher
+ * @brief Constant stride detection for each process
+ *
+ * Remembers the last page and the stride between the last two
+ * triggers of each process.  When the same non zero stride is seen
+ * twice in a row, the next degree pages along the stride are
+ * prefetched.
+ */
+class StridePrefetcher : public Prefetcher
+{
+private:
+  /// the stride detection state of a single process
+  struct ProcessStride
+  {
+    int lastPage;
+    int stride;
+  };
+
+  int degree;
+  vector<ProcessStride> processes;
+
+public:
+  StridePrefetcher(int degree = DEFAULT_PREFETCH_DEGREE);
+  string getName() const;
+  void reset();
+  void trigger(int processId, int pageNumber, vector<int>& prefetchPages);
+};
+
+/** @class StreamPrefetcher
+ * @brief Multiple stream tracker
+ *
+ * Tracks a number of streams, each moving forward or backward
+ * through the pages of a process, so interleaved sequential streams,
+ * of the same process or of different processes, are each followed.
+ * A trigger near the end of a stream, in its direction, extends it,
+ * and once a stream has been extended it prefetches the next degree
+ * pages in its direction.  A trigger that continues no stream starts
+ * a new one in place of the least recently used.
+ */
+class StreamPrefetcher : public Prefetcher
+{
+private:
+  /// a single stream being tracked
+  struct Stream
+  {
+    int processId;
+    int lastPage;
+    int direction;
+    long lastUsed;
+  };
+
+  int degree;
+  vector<Stream> streams;
+  long time;
+
+public:
+  StreamPrefetcher(int degree = DEFAULT_PREFETCH_DEGREE, int numStreams = DEFAULT_NUM_STREAMS);
+  string getName() const;
+  void reset();
+  void trigger(int processId, int pageNumber, vector<int>& prefetchPages);
+};
+
+Prefetcher* makePrefetcher(const string& prefetcherName, int degree);
+
+#endif // PREFETCHER_HPP
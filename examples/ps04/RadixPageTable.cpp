@@ -0,0 +1,244 @@
+/** @file RadixPageTable.cpp
+ * @brief A model of a multi-level (radix tree) page table.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the radix page table model.
+ */
+#include "RadixPageTable.hpp"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+/// an upper level page table entry that does not point to a table
+const int64_t NO_TABLE = -1;
+
+/** default constructor
+ * A page table model with no levels, configure() must be called
+ * before it is used.
+ */
+RadixPageTable::RadixPageTable()
+{
+  levels = 0;
+  pageShift = 0;
+  reset();
+}
+
+
+/** configure
+ * Set the shape of the page tables, and start over with no processes.
+ * The bits of the virtual page number are shared out as evenly as
+ * possible between the levels, any left over bits go to the top
+ * levels.  For example 4K pages leave 36 of the 48 address bits for
+ * the page number, which 4 levels split into 9 bits each, as on
+ * x86-64.
+ *
+ * @param levels The number of levels of the page tables.
+ * @param pageShift The number of bits of the page offset.
+ */
+void RadixPageTable::configure(int levels, int pageShift)
+{
+  if (levels < 1 or levels > MAX_PAGE_TABLE_LEVELS or pageShift >= VIRTUAL_ADDRESS_BITS)
+  {
+    cerr << "Error: RadixPageTable::configure() can not model " << levels << " levels" << endl
+         << "   with " << pageShift << " bits of page offset" << endl;
+    exit(1);
+  }
+
+  this->levels = levels;
+  this->pageShift = pageShift;
+
+  int pageNumberBits = VIRTUAL_ADDRESS_BITS - pageShift;
+  int shift = pageNumberBits;
+  for (int level = 0; level < levels; level++)
+  {
+    levelBits[level] = pageNumberBits / levels + ((level < pageNumberBits % levels) ? 1 : 0);
+    shift -= levelBits[level];
+    levelShift[level] = shift;
+  }
+
+  reset();
+}
+
+
+/** reset
+ * Start over with no processes and no tables.
+ */
+void RadixPageTable::reset()
+{
+  entries.clear();
+  roots.clear();
+  for (int level = 0; level < MAX_PAGE_TABLE_LEVELS; level++)
+  {
+    tablesPerLevel[level] = 0;
+  }
+  numWalks = 0;
+  walkAccesses = 0;
+}
+
+
+/** number of levels
+ * @returns int The number of levels of the page tables, 0 if not
+ *   configured.
+ */
+int RadixPageTable::getLevels() const
+{
+  return levels;
+}
+
+
+/** allocate table
+ * Allocate a new empty table for the indicated level.
+ *
+ * @param level The level of the new table.
+ *
+ * @returns int64_t The position of the table in the entries.
+ */
+int64_t RadixPageTable::allocateTable(int level)
+{
+  int64_t table = entries.size();
+  int64_t empty = (level == levels - 1) ? 0 : NO_TABLE;
+  entries.resize(entries.size() + (1L << levelBits[level]), empty);
+  tablesPerLevel[level]++;
+  return table;
+}
+
+
+/** add process
+ * Add a process with an empty page table, only the top level table
+ * is allocated.  Processes must be added in order of their ids.
+ *
+ * @param processId The id of the new process.
+ */
+void RadixPageTable::addProcess(int processId)
+{
+  roots.push_back(allocateTable(0));
+}
+
+
+/** walk
+ * Walk the page table of a process to translate a page number, as
+ * the hardware does on a translation.  The walk stops early if it
+ * reaches a part of the address space with no table.
+ *
+ * @param processId The process whose page table is walked.
+ * @param pageNumber The virtual page number to translate.
+ *
+ * @returns int The depth of the walk, the number of page table
+ *   entries read.
+ */
+int RadixPageTable::walk(int processId, long pageNumber)
+{
+  int64_t table = roots[processId];
+  int depth = 0;
+  for (int level = 0; level < levels; level++)
+  {
+    depth++;
+    int64_t entry = entries[table + ((pageNumber >> levelShift[level]) & ((1L << levelBits[level]) - 1))];
+    if (level == levels - 1 or entry == NO_TABLE)
+    {
+      break;
+    }
+    table = entry;
+  }
+
+  numWalks++;
+  walkAccesses += depth;
+  return depth;
+}
+
+
+/** map
+ * Mark a page present in the page table of a process, allocating
+ * any tables needed on the way down.
+ *
+ * @param processId The process whose page table is updated.
+ * @param pageNumber The virtual page number of the page.
+ */
+void RadixPageTable::map(int processId, long pageNumber)
+{
+  int64_t table = roots[processId];
+  for (int level = 0; level < levels - 1; level++)
+  {
+    int64_t index = table + ((pageNumber >> levelShift[level]) & ((1L << levelBits[level]) - 1));
+    if (entries[index] == NO_TABLE)
+    {
+      // allocating may move the entries, so look the entry up again
+      int64_t next = allocateTable(level + 1);
+      entries[index] = next;
+    }
+    table = entries[index];
+  }
+
+  entries[table + (pageNumber & ((1L << levelBits[levels - 1]) - 1))] = 1;
+}
+
+
+/** unmap
+ * Mark a page not present in the page table of a process.  Like a
+ * real operating system we keep the tables of the page around, they
+ * are likely to be needed again.
+ *
+ * @param processId The process whose page table is updated.
+ * @param pageNumber The virtual page number of the page.
+ */
+void RadixPageTable::unmap(int processId, long pageNumber)
+{
+  int64_t table = roots[processId];
+  for (int level = 0; level < levels - 1; level++)
+  {
+    table = entries[table + ((pageNumber >> levelShift[level]) & ((1L << levelBits[level]) - 1))];
+    if (table == NO_TABLE)
+    {
+      return;
+    }
+  }
+
+  entries[table + (pageNumber & ((1L << levelBits[levels - 1]) - 1))] = 0;
+}
+
+
+/** number of walks
+ * @returns long The number of page walks done.
+ */
+long RadixPageTable::getNumWalks() const
+{
+  return numWalks;
+}
+
+
+/** average walk depth
+ * @returns double The average number of page table entries read by a
+ *   page walk.
+ */
+double RadixPageTable::getAverageWalkDepth() const
+{
+  return (numWalks == 0) ? 0.0 : double(walkAccesses) / numWalks;
+}
+
+
+/** number of tables
+ * @returns long The number of tables (nodes) of all the page tables.
+ */
+long RadixPageTable::getNumTables() const
+{
+  long numTables = 0;
+  for (int level = 0; level < levels; level++)
+  {
+    numTables += tablesPerLevel[level];
+  }
+  return numTables;
+}
+
+
+/** table bytes
+ * @returns long The memory used by all the page tables, in bytes.
+ */
+long RadixPageTable::getTableBytes() const
+{
+  return long(entries.size()) * PAGE_TABLE_ENTRY_BYTES;
+}
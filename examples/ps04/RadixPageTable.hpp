@@ -0,0 +1,80 @@
+/** @file RadixPageTable.hpp
+ * @brief A model of a multi-level (radix tree) page table.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Real hardware page tables are radix trees.  The virtual page
+ * number is split into fields, one for each level of the tree, and
+ * translating an address walks down the tree using each field in
+ * turn to index a table, until the page table entry at the bottom
+ * level is reached.  Tables are only allocated for parts of the
+ * address space that are in use, so large sparse address spaces
+ * need little page table memory, at the cost of a memory access at
+ * each level of every walk.
+ *
+ * This models such a page table for each process so we can measure
+ * the depth of page walks, and how much memory the page tables take.
+ * The DynamicPagingSimulator still uses its flat page table to
+ * decide hits and faults, the model only keeps the statistics.
+ */
+#ifndef RADIX_PAGE_TABLE_HPP
+#define RADIX_PAGE_TABLE_HPP
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/// the size of the virtual addresses of the modeled machine
+const int VIRTUAL_ADDRESS_BITS = 48;
+/// the size of a page table entry of the modeled machine
+const int PAGE_TABLE_ENTRY_BYTES = 8;
+/// the most levels a radix page table can have
+const int MAX_PAGE_TABLE_LEVELS = 5;
+
+/** @class RadixPageTable
+ * @brief Multi-level page tables of a set of processes
+ *
+ * All of the tables (nodes) of all of the trees are kept in one
+ * flat array of entries.  An entry of an upper level table holds the
+ * position in the array of the next level table it points to, or
+ * NO_TABLE, and an entry of a bottom level table is 1 if the page is
+ * present and 0 if not.
+ */
+class RadixPageTable
+{
+private:
+  int levels;
+  int pageShift;
+  /// the bit position and size of the index field of each level,
+  /// level 0 is the top of the tree
+  int levelShift[MAX_PAGE_TABLE_LEVELS];
+  int levelBits[MAX_PAGE_TABLE_LEVELS];
+
+  vector<int64_t> entries;
+  vector<int64_t> roots;
+  long tablesPerLevel[MAX_PAGE_TABLE_LEVELS];
+
+  long numWalks;
+  long walkAccesses;
+
+  int64_t allocateTable(int level);
+
+public:
+  RadixPageTable();
+  void configure(int levels, int pageShift);
+  void reset();
+  int getLevels() const;
+  void addProcess(int processId);
+  int walk(int processId, long pageNumber);
+  void map(int processId, long pageNumber);
+  void unmap(int processId, long pageNumber);
+  long getNumWalks() const;
+  double getAverageWalkDepth() const;
+  long getNumTables() const;
+  long getTableBytes() const;
+};
+
+#endif // RADIX_PAGE_TABLE_HPP
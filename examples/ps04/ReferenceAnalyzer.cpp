@@ -0,0 +1,370 @@
+/** @file ReferenceAnalyzer.cpp
+ * @brief Analyses of the reference streams of the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the reference analyzers.
+ */
+#include "ReferenceAnalyzer.hpp"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+/// the time a page that has never been referenced was last referenced
+const long NEVER_REFERENCED = -1;
+/// the initial number of positions of the stack distance tree
+const long INITIAL_STACK_POSITIONS = 1024;
+/// the page of a position of the stack distance tree that is not marked
+const int NO_STACK_PAGE = -1;
+
+
+/** reference analyzer destructor
+ * Virtual destructor so analyzers can be deleted through a base
+ * class pointer.
+ */
+ReferenceAnalyzer::~ReferenceAnalyzer()
+{
+}
+
+
+/** working set analyzer constructor
+ * @param windowSize The working set window delta, in references.
+ * @param sampleInterval Sample the working set size and page faults
+ *   every sampleInterval references of each process, or 0 to only
+ *   keep the totals.
+ */
+WorkingSetAnalyzer::WorkingSetAnalyzer(long windowSize, long sampleInterval)
+{
+  if (windowSize < 1 or sampleInterval < 0)
+  {
+    cerr << "Error: WorkingSetAnalyzer::WorkingSetAnalyzer() invalid window size: " << windowSize << endl
+         << "   or sample interval: " << sampleInterval << endl;
+    exit(1);
+  }
+
+  this->windowSize = windowSize;
+  this->sampleInterval = sampleInterval;
+}
+
+
+/** reset
+ * Start over with no processes.
+ */
+void WorkingSetAnalyzer::reset()
+{
+  processes.clear();
+}
+
+
+/** add process
+ * Start keeping the working set of a new process, initially empty.
+ *
+ * @param processId The id of the new process.
+ * @param processName The name of the process, e.g. A, B or C.
+ * @param numPages The number of virtual pages of the process.
+ */
+void WorkingSetAnalyzer::addProcess(int processId, const string& processName, int numPages)
+{
+  ProcessWorkingSet process;
+  process.name = processName;
+  process.time = 0;
+  process.workingSetSize = 0;
+  process.lastReference.assign(numPages, NEVER_REFERENCED);
+  process.window.assign(windowSize, 0);
+  process.faults = 0;
+  process.intervalFaults = 0;
+  process.workingSetSum = 0;
+  process.maxWorkingSetSize = 0;
+  processes.push_back(process);
+}
+
+
+/** reference
+ * Move the working set window of the process forward by one
+ * reference, updating its working set size.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ * @param pageFault True if the reference was a page fault.
+ */
+void WorkingSetAnalyzer::reference(int processId, int pageNumber, bool pageFault)
+{
+  ProcessWorkingSet& process = processes[processId];
+  long time = process.time;
+  int slot = time % windowSize;
+
+  // the oldest reference leaves the window, and its page leaves the
+  // working set if it has not been referenced again since
+  if (time >= windowSize)
+  {
+    int oldPage = process.window[slot];
+    if (process.lastReference[oldPage] == time - windowSize)
+    {
+      process.workingSetSize--;
+    }
+  }
+
+  // and the new reference enters it
+  long& lastReference = process.lastReference[pageNumber];
+  if (lastReference == NEVER_REFERENCED or lastReference <= time - windowSize)
+  {
+    process.workingSetSize++;
+  }
+  lastReference = time;
+  process.window[slot] = pageNumber;
+  process.time++;
+
+  process.workingSetSum += process.workingSetSize;
+  if (process.workingSetSize > process.maxWorkingSetSize)
+  {
+    process.maxWorkingSetSize = process.workingSetSize;
+  }
+  if (pageFault)
+  {
+    process.faults++;
+    process.intervalFaults++;
+  }
+
+  if (sampleInterval > 0 and process.time % sampleInterval == 0)
+  {
+    WorkingSetSample sample = {process.time, process.workingSetSize, process.intervalFaults};
+    process.samples.push_back(sample);
+    process.intervalFaults = 0;
+  }
+}
+
+
+/** display results
+ * Display the mean and maximum working set size and the page fault
+ * frequency of each process, and the samples of them over time.
+ *
+ * @param out The stream to display the results on.
+ */
+void WorkingSetAnalyzer::displayResults(ostream& out)
+{
+  out << "<WorkingSetAnalyzer> working set window: " << windowSize << " references" << "\n";
+  for (const ProcessWorkingSet& process : processes)
+  {
+    out << "    Matrix " << process.name << " references: " << process.time
+        << " mean working set: " << ((process.time == 0) ? 0.0 : double(process.workingSetSum) / process.time)
+        << " pages max: " << process.maxWorkingSetSize
+        << " fault rate: " << ((process.time == 0) ? 0.0 : double(process.faults) / process.time) << "\n";
+
+    for (const WorkingSetSample& sample : process.samples)
+    {
+      out << "        t: " << sample.time << " working set: " << sample.workingSetSize
+          << " faults: " << sample.faults << " fault rate: " << double(sample.faults) / sampleInterval << "\n";
+    }
+  }
+}
+
+
+/** stack distance analyzer constructor
+ * Start with no processes and an empty stack.
+ */
+StackDistanceAnalyzer::StackDistanceAnalyzer()
+{
+  reset();
+}
+
+
+/** reset
+ * Start over with no processes and an empty stack.
+ */
+void StackDistanceAnalyzer::reset()
+{
+  processBase.clear();
+  lastPosition.clear();
+  tree.assign(INITIAL_STACK_POSITIONS + 1, 0);
+  positionPage.assign(INITIAL_STACK_POSITIONS, NO_STACK_PAGE);
+  nextPosition = 0;
+  distanceCounts.assign(1, 0);
+  coldMisses = 0;
+  numReferences = 0;
+}
+
+
+/** add process
+ * Give the pages of a new process the next block of page numbers.
+ *
+ * @param processId The id of the new process.
+ * @param processName The name of the process, e.g. A, B or C.
+ * @param numPages The number of virtual pages of the process.
+ */
+void StackDistanceAnalyzer::addProcess(int processId, const string& processName, int numPages)
+{
+  processBase.push_back(lastPosition.size());
+  lastPosition.resize(lastPosition.size() + numPages, NEVER_REFERENCED);
+  distanceCounts.resize(lastPosition.size() + 1, 0);
+}
+
+
+/** add mark
+ * Add delta to the count of marks at a position of the tree.
+ *
+ * @param position The position, from 0.
+ * @param delta The change of the count, 1 to mark or -1 to unmark.
+ */
+void StackDistanceAnalyzer::addMark(long position, int delta)
+{
+  for (long index = position + 1; index < long(tree.size()); index += index & -index)
+  {
+    tree[index] += delta;
+  }
+}
+
+
+/** count marks
+ * @param position The position, from 0.
+ *
+ * @returns int The number of marks at positions 0 to position.
+ */
+int StackDistanceAnalyzer::countMarks(long position) const
+{
+  int count = 0;
+  for (long index = position + 1; index > 0; index -= index & -index)
+  {
+    count += tree[index];
+  }
+  return count;
+}
+
+
+/** compact
+ * The positions have run out, move the marks, the last references of
+ * the pages, to the front in the same order, growing the tree if more
+ * than half of it would still be in use, and rebuild the tree.
+ */
+void StackDistanceAnalyzer::compact()
+{
+  vector<int> pages;
+  for (long position = 0; position < nextPosition; position++)
+  {
+    int page = positionPage[position];
+    if (page != NO_STACK_PAGE and lastPosition[page] == position)
+    {
+      pages.push_back(page);
+    }
+  }
+
+  long numPositions = positionPage.size();
+  if (long(pages.size()) * 2 > numPositions)
+  {
+    numPositions *= 2;
+  }
+
+  positionPage.assign(numPositions, NO_STACK_PAGE);
+  tree.assign(numPositions + 1, 0);
+  for (long position = 0; position < long(pages.size()); position++)
+  {
+    positionPage[position] = pages[position];
+    lastPosition[pages[position]] = position;
+    tree[position + 1] = 1;
+  }
+  nextPosition = pages.size();
+
+  // build the Fenwick tree in linear time, each node adds its count
+  // to its parent
+  for (long index = 1; index <= numPositions; index++)
+  {
+    long parent = index + (index & -index);
+    if (parent <= numPositions)
+    {
+      tree[parent] += tree[index];
+    }
+  }
+}
+
+
+/** reference
+ * Find the stack distance of the reference and count it, and move
+ * the page to the top of the stack.
+ *
+ * @param processId The id of the process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ * @param pageFault True if the reference was a page fault, not used,
+ *   the faults of every number of frames are worked out instead.
+ */
+void StackDistanceAnalyzer::reference(int processId, int pageNumber, bool pageFault)
+{
+  if (nextPosition == long(positionPage.size()))
+  {
+    compact();
+  }
+
+  int page = processBase[processId] + pageNumber;
+  long last = lastPosition[page];
+  if (last == NEVER_REFERENCED)
+  {
+    coldMisses++;
+  }
+  else
+  {
+    // the marks from the last reference of the page up to now are the
+    // distinct pages referenced since, including the page itself
+    int distance = countMarks(nextPosition - 1) - countMarks(last - 1);
+    distanceCounts[distance]++;
+    addMark(last, -1);
+    positionPage[last] = NO_STACK_PAGE;
+  }
+
+  addMark(nextPosition, 1);
+  positionPage[nextPosition] = page;
+  lastPosition[page] = nextPosition;
+  nextPosition++;
+  numReferences++;
+}
+
+
+/** get faults
+ * @param numFrames The number of frames.
+ *
+ * @returns long The number of page faults LRU replacement would have
+ *   with the indicated number of frames.
+ */
+long StackDistanceAnalyzer::getFaults(int numFrames) const
+{
+  long faults = coldMisses;
+  for (int distance = numFrames + 1; distance < int(distanceCounts.size()); distance++)
+  {
+    faults += distanceCounts[distance];
+  }
+  return faults;
+}
+
+
+/** display results
+ * Display the miss ratio curve, the LRU page faults and miss ratio
+ * for every number of frames up to the number of pages.  Only the
+ * numbers of frames where the faults change are shown, the faults of
+ * the numbers of frames in between are those of the line above.
+ *
+ * @param out The stream to display the results on.
+ */
+void StackDistanceAnalyzer::displayResults(ostream& out)
+{
+  out << "<StackDistanceAnalyzer> LRU page faults for every number of frames" << "\n";
+
+  // sum the distance counts from the largest distance down, so the
+  // faults of each number of frames are found in one pass
+  int numPages = lastPosition.size();
+  vector<long> faults(numPages + 1);
+  faults[numPages] = coldMisses;
+  for (int numFrames = numPages - 1; numFrames >= 0; numFrames--)
+  {
+    faults[numFrames] = faults[numFrames + 1] + distanceCounts[numFrames + 1];
+  }
+
+  for (int numFrames = 1; numFrames <= numPages; numFrames++)
+  {
+    if (numFrames == 1 or faults[numFrames] != faults[numFrames - 1])
+    {
+      out << "    frames: " << numFrames << " faults: " << faults[numFrames] << " miss ratio: "
+          << ((numReferences == 0) ? 0.0 : double(faults[numFrames]) / numReferences) << "\n";
+    }
+  }
+}
@@ -0,0 +1,162 @@
+/** @file ReferenceAnalyzer.hpp
+ * @brief Analyses of the reference streams of the paging simulator.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Reference analyzers are given every reference the
+ * DynamicPagingSimulator simulates, and whether it was a page fault,
+ * so they can work out more about the reference stream than the fault
+ * count of a single simulation, in the same pass as the simulation.
+ * Their results are displayed with the results of the simulator.
+ */
+#ifndef REFERENCE_ANALYZER_HPP
+#define REFERENCE_ANALYZER_HPP
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/** @class ReferenceAnalyzer
+ * @brief Abstract analyzer of a reference stream
+ *
+ * The interface all reference analyzers implement.  Processes are
+ * added in order of their process ids starting from 0, as they are
+ * added to the simulator, before they make any references.
+ */
+class ReferenceAnalyzer
+{
+public:
+  virtual ~ReferenceAnalyzer();
+
+  /// @brief Start over with no processes
+  virtual void reset() = 0;
+  /// @brief A process with the indicated number of pages was added
+  virtual void addProcess(int processId, const string& processName, int numPages) = 0;
+  /// @brief A process referenced a page, which may have page faulted
+  virtual void reference(int processId, int pageNumber, bool pageFault) = 0;
+  /// @brief Display the results of the analysis
+  virtual void displayResults(ostream& out) = 0;
+};
+
+/** Working set sample
+ * The working set size and page faults of a process at one point in
+ * its virtual time.
+ */
+struct WorkingSetSample
+{
+  /// the virtual time of the sample, the number of references the
+  /// process had made
+  long time;
+  /// the working set size W(t, delta) at the time, in pages
+  int workingSetSize;
+  /// the page faults since the previous sample
+  long faults;
+};
+
+/** @class WorkingSetAnalyzer
+ * @brief Working set size and page fault frequency of each process
+ *
+ * The working set W(t, delta) of a process is the set of distinct
+ * pages it referenced in its last delta references, measured in the
+ * virtual time of the process, its own count of references.  Each
+ * process keeps its last delta references in a ring buffer, and the
+ * time each of its pages was last referenced.  A reference adds its
+ * page to the working set if the page was not referenced within the
+ * window, and the reference leaving the window removes its page if
+ * that was the last reference to it.  So the working set size is
+ * kept up to date with a constant amount of work per reference.
+ *
+ * The working set size and the page faults of the interval (the page
+ * fault frequency) are sampled every sample interval references.
+ */
+class WorkingSetAnalyzer : public ReferenceAnalyzer
+{
+private:
+  /// the working set state of a single process
+  struct ProcessWorkingSet
+  {
+    string name;
+    long time;
+    int workingSetSize;
+    vector<long> lastReference;
+    vector<int> window;
+    long faults;
+    long intervalFaults;
+    long workingSetSum;
+    int maxWorkingSetSize;
+    vector<WorkingSetSample> samples;
+  };
+
+  long windowSize;
+  long sampleInterval;
+  vector<ProcessWorkingSet> processes;
+
+public:
+  WorkingSetAnalyzer(long windowSize, long sampleInterval = 0);
+  void reset();
+  void addProcess(int processId, const string& processName, int numPages);
+  void reference(int processId, int pageNumber, bool pageFault);
+  void displayResults(ostream& out);
+};
+
+/** @class StackDistanceAnalyzer
+ * @brief LRU page faults for every number of frames in one pass
+ *
+ * Mattson's stack algorithm.  LRU has the inclusion property, the
+ * pages resident with n frames are always also resident with n + 1
+ * frames, so a reference hits with n frames exactly when its stack
+ * distance, the number of distinct pages referenced since the last
+ * reference to its page (including the page), is at most n.  A
+ * histogram of the stack distances gives the LRU page faults for
+ * every number of frames at once.
+ *
+ * Instead of searching an LRU stack, which is linear in the number
+ * of pages, each reference is given the next position in time, and
+ * a Fenwick (binary indexed) tree over the positions marks the
+ * position of the last reference to each page.  The stack distance
+ * is then the count of marks from the last reference of the page up
+ * to now, in O(log n).  When the positions run out the marks are
+ * compacted to the front, keeping their order, and the tree grows if
+ * more than half of it is still in use, so it stays proportional to
+ * the number of distinct pages rather than the number of references.
+ *
+ * Pages of all processes share the frame pool, so the stack is
+ * global across all of the processes.
+ */
+class StackDistanceAnalyzer : public ReferenceAnalyzer
+{
+private:
+  /// the start of the pages of each process in our page numbering,
+  /// which is the same as the flat page table of the simulator
+  vector<int> processBase;
+  vector<long> lastPosition;
+
+  /// the Fenwick tree of marks, indexed from 1, and the page whose
+  /// reference was given each position
+  vector<int> tree;
+  vector<int> positionPage;
+  long nextPosition;
+
+  /// distanceCounts[d] is the number of references at stack distance d
+  vector<long> distanceCounts;
+  long coldMisses;
+  long numReferences;
+
+  void addMark(long position, int delta);
+  int countMarks(long position) const;
+  void compact();
+
+public:
+  StackDistanceAnalyzer();
+  void reset();
+  void addProcess(int processId, const string& processName, int numPages);
+  void reference(int processId, int pageNumber, bool pageFault);
+  long getFaults(int numFrames) const;
+  void displayResults(ostream& out);
+};
+
+#endif // REFERENCE_ANALYZER_HPP
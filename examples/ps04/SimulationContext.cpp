@@ -0,0 +1,170 @@
+/** @file SimulationContext.cpp
+ * @brief The state shared by the matrices of one paging simulation.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the simulation context.
+ */
+#include "SimulationContext.hpp"
+
+using namespace std;
+
+/// the number of letters matrix names are made of
+const int NAME_LETTERS = 26;
+
+
+/** simulation context constructor
+ * A new simulation, with a paging simulator of the default number of
+ * frames and replacement policy, and no matrices yet.
+ */
+SimulationContext::SimulationContext()
+{
+  recorder = NULL;
+  cache = NULL;
+  nextBaseAddress = 0;
+  nextMatrixId = 0;
+}
+
+
+/** get default
+ * The context matrices are constructed in when no other context is
+ * given.  It lasts as long as the program does.
+ *
+ * @returns SimulationContext* The default context.
+ */
+SimulationContext* SimulationContext::getDefault()
+{
+  static SimulationContext* defaultContext = new SimulationContext();
+  return defaultContext;
+}
+
+
+/** get pager
+ * Access the paging simulator of the context, for example to
+ * configure the frames and replacement policy to simulate.
+ *
+ * @returns DynamicPagingSimulator* The paging simulator.
+ */
+DynamicPagingSimulator* SimulationContext::getPager()
+{
+  return &pager;
+}
+
+
+/** get arena
+ * @returns PageArena* The arena the storage of the matrices of the
+ *   context comes from.
+ */
+PageArena* SimulationContext::getArena()
+{
+  return &arena;
+}
+
+
+/** set recorder
+ * Start or stop recording the references of the matrices.  While
+ * recording, matrices must be created after the recorder is set so
+ * that they are added to the recording.
+ *
+ * @param recorder The recorder to record references to, or NULL to
+ *   stop recording.
+ */
+void SimulationContext::setRecorder(TraceRecorder* recorder)
+{
+  this->recorder = recorder;
+}
+
+
+/** set cache
+ * Start or stop simulating the caches with the references of the
+ * matrices.  Matrices must be created after the cache simulator is
+ * set so that they are given an address for it.
+ *
+ * @param cache The cache simulator to simulate references with, or
+ *   NULL to stop simulating the caches.
+ */
+void SimulationContext::setCache(CacheSimulator* cache)
+{
+  this->cache = cache;
+}
+
+
+/** allocate matrix id
+ * @returns int The id of a new matrix, which is also its process id
+ *   in the paging simulator.  Ids start from 0 in each simulation.
+ */
+int SimulationContext::allocateMatrixId()
+{
+  return nextMatrixId++;
+}
+
+
+/** allocate base address
+ * Place a new matrix after the matrices before it in the address
+ * space seen by the caches.
+ *
+ * @param numBytes The size of the address space of the matrix, a
+ *   whole number of pages.
+ *
+ * @returns long The address the matrix starts at.
+ */
+long SimulationContext::allocateBaseAddress(long numBytes)
+{
+  long baseAddress = nextBaseAddress;
+  nextBaseAddress += numBytes;
+  return baseAddress;
+}
+
+
+/** matrix name
+ * The name of the matrix with the indicated id, as a spreadsheet
+ * names its columns.  The first matrix is named A, the 26th Z, then
+ * the names go on AA, AB and so on.
+ *
+ * @param matrixId The id of the matrix.
+ *
+ * @returns string The name of the matrix.
+ */
+string SimulationContext::matrixName(int matrixId)
+{
+  string name;
+  for (int number = matrixId + 1; number > 0; number = (number - 1) / NAME_LETTERS)
+  {
+    name.insert(name.begin(), char('A' + (number - 1) % NAME_LETTERS));
+  }
+  return name;
+}
+
+
+/** end simulation
+ * Display the results of the simulation, and start over for another.
+ */
+void SimulationContext::endSimulation()
+{
+  pager.displayResults();
+  if (cache != NULL)
+  {
+    cache->displayResults();
+  }
+  resetSimulation();
+}
+
+
+/** reset simulation
+ * Start over for another simulation, without displaying the results.
+ * All matrices are removed from the paging simulator, so the matrices
+ * of the next simulation start with id 0 again.
+ */
+void SimulationContext::resetSimulation()
+{
+  nextMatrixId = 0;
+  nextBaseAddress = 0;
+  pager.resetSimulation();
+  if (cache != NULL)
+  {
+    cache->resetSimulation();
+  }
+}
@@ -0,0 +1,98 @@
+/** @file SimulationContext.hpp
+ * @brief The state shared by the matrices of one paging simulation.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * A simulation context owns everything the matrices of a simulation
+ * share: the paging simulator, the ids and names given to the
+ * matrices, the address space the caches see them in, and the arena
+ * their storage comes from.  Matrices are constructed in a context,
+ * the default context unless another is given.  Simulations in
+ * different contexts are isolated from each other, so they can run
+ * at the same time on different threads.
+ */
+#ifndef SIMULATION_CONTEXT_HPP
+#define SIMULATION_CONTEXT_HPP
+#include "CacheSimulator.hpp"
+#include "DynamicPagingSimulator.hpp"
+#include "PageArena.hpp"
+#include "TraceRecorder.hpp"
+#include <string>
+
+using namespace std;
+
+/** @class SimulationContext
+ * @brief One paging simulation of matrices
+ *
+ * A context is not thread safe, all of the matrices of a context must
+ * be used by one thread at a time.  The recorder and cache simulator
+ * are not owned by the context.
+ */
+class SimulationContext
+{
+private:
+  DynamicPagingSimulator pager;
+  PageArena arena;
+
+  // when recording, all matrix references are also recorded here
+  TraceRecorder* recorder;
+
+  // when simulating the caches, all matrix references also go through
+  // the cache simulator.  The matrices are placed one after another,
+  // page aligned, in a single address space for it, as a program using
+  // them would allocate them.
+  CacheSimulator* cache;
+  long nextBaseAddress;
+
+  /// the id the next matrix constructed is given
+  int nextMatrixId;
+
+public:
+  SimulationContext();
+  SimulationContext(const SimulationContext&) = delete;
+  SimulationContext& operator=(const SimulationContext&) = delete;
+  static SimulationContext* getDefault();
+
+  DynamicPagingSimulator* getPager();
+  PageArena* getArena();
+  void setRecorder(TraceRecorder* recorder);
+  TraceRecorder* getRecorder() const;
+  void setCache(CacheSimulator* cache);
+  CacheSimulator* getCache() const;
+
+  int allocateMatrixId();
+  long allocateBaseAddress(long numBytes);
+  static string matrixName(int matrixId);
+
+  void endSimulation();
+  void resetSimulation();
+};
+
+
+/** get recorder
+ * Needed on every matrix reference, so defined inline here.
+ *
+ * @returns TraceRecorder* The recorder all matrix references are
+ *   recorded to, or NULL if they are not being recorded.
+ */
+inline TraceRecorder* SimulationContext::getRecorder() const
+{
+  return recorder;
+}
+
+
+/** get cache
+ * Needed on every matrix reference, so defined inline here.
+ *
+ * @returns CacheSimulator* The cache simulator all matrix references
+ *   go through, or NULL if the caches are not being simulated.
+ */
+inline CacheSimulator* SimulationContext::getCache() const
+{
+  return cache;
+}
+
+#endif // SIMULATION_CONTEXT_HPP
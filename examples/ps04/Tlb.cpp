@@ -0,0 +1,244 @@
+/** @file Tlb.cpp
+ * @brief A model of a translation lookaside buffer.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the set associative TLB model.
+ */
+#include "Tlb.hpp"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+/// key of an empty TLB entry, real keys are never 0
+const uint64_t EMPTY_TLB_ENTRY = 0;
+/// the process id of no process, before the first reference
+const int NO_TLB_PROCESS = -1;
+
+/** default constructor
+ * A TLB with no entries, which misses on every lookup.  configure()
+ * must be called to give it some entries.
+ */
+Tlb::Tlb()
+{
+  numEntries = 0;
+  ways = 1;
+  numSets = 0;
+  asidTagging = false;
+  reset();
+}
+
+
+/** configure
+ * Set the size and organization of the TLB, and start over with it
+ * empty.  The number of sets (entries / ways) must be a power of 2,
+ * as it is in hardware, so the set of a page is given by the low bits
+ * of the page number.
+ *
+ * @param numEntries The total number of entries.
+ * @param ways The number of entries in each set, ways == numEntries
+ *   gives a fully associative TLB.
+ * @param asidTagging True to tag entries with the process id, false
+ *   to flush the TLB whenever the process making references changes.
+ */
+void Tlb::configure(int numEntries, int ways, bool asidTagging)
+{
+  int numSets = (ways > 0) ? numEntries / ways : 0;
+  if (numEntries < 1 or ways < 1 or numEntries % ways != 0 or (numSets & (numSets - 1)) != 0)
+  {
+    cerr << "Error: Tlb::configure() can not have " << numEntries << " entries" << endl
+         << "   with " << ways << " ways, the number of sets must be a power of 2" << endl;
+    exit(1);
+  }
+
+  this->numEntries = numEntries;
+  this->ways = ways;
+  this->numSets = numSets;
+  this->asidTagging = asidTagging;
+  reset();
+}
+
+
+/** reset
+ * Start over with an empty TLB and cleared counts.
+ */
+void Tlb::reset()
+{
+  keys.assign(numEntries, EMPTY_TLB_ENTRY);
+  lastUsed.assign(numEntries, 0);
+  time = 0;
+  currentProcessId = NO_TLB_PROCESS;
+  hits = 0;
+  misses = 0;
+  flushes = 0;
+}
+
+
+/** number of entries
+ * @returns int The number of entries of the TLB, 0 if there is no TLB.
+ */
+int Tlb::getNumEntries() const
+{
+  return numEntries;
+}
+
+
+/** ways
+ * @returns int The number of entries in each set.
+ */
+int Tlb::getWays() const
+{
+  return ways;
+}
+
+
+/** ASID tagging
+ * @returns bool True if entries are tagged with the process id.
+ */
+bool Tlb::getAsidTagging() const
+{
+  return asidTagging;
+}
+
+
+/** make key
+ * Make the key of the translation of a page.  The page number is in
+ * the low 40 bits, the ASID above it, and 1 is added so that no key
+ * is ever EMPTY_TLB_ENTRY.
+ *
+ * @param processId The process whose page it is.
+ * @param pageNumber The virtual page number.
+ *
+ * @returns uint64_t The key of the translation.
+ */
+uint64_t Tlb::makeKey(int processId, long pageNumber) const
+{
+  uint64_t asid = asidTagging ? uint64_t(processId) : 0;
+  return ((asid << 40) | uint64_t(pageNumber)) + 1;
+}
+
+
+/** flush
+ * Invalidate every entry, as on a context switch without ASIDs.
+ */
+void Tlb::flush()
+{
+  keys.assign(numEntries, EMPTY_TLB_ENTRY);
+  lastUsed.assign(numEntries, 0);
+  flushes++;
+}
+
+
+/** lookup
+ * Look up the translation of a page.  On a miss the translation is
+ * loaded into the least recently used entry of its set, as it would
+ * be after the page table walk that follows a TLB miss.
+ *
+ * @param processId The process making the reference.
+ * @param pageNumber The virtual page being referenced.
+ *
+ * @returns bool True on a TLB hit, false on a miss.
+ */
+bool Tlb::lookup(int processId, long pageNumber)
+{
+  if (not asidTagging and processId != currentProcessId)
+  {
+    if (currentProcessId != NO_TLB_PROCESS)
+    {
+      flush();
+    }
+    currentProcessId = processId;
+  }
+
+  time++;
+  uint64_t key = makeKey(processId, pageNumber);
+  int first = (pageNumber & (numSets - 1)) * ways;
+  int victim = first;
+  for (int entry = first; entry < first + ways; entry++)
+  {
+    if (keys[entry] == key)
+    {
+      lastUsed[entry] = time;
+      hits++;
+      return true;
+    }
+    // empty entries were last used at time 0, so they are used first
+    if (lastUsed[entry] < lastUsed[victim])
+    {
+      victim = entry;
+    }
+  }
+
+  keys[victim] = key;
+  lastUsed[victim] = time;
+  misses++;
+  return false;
+}
+
+
+/** invalidate
+ * Remove the translation of a page, if it is in the TLB, as when the
+ * page is evicted from memory.
+ *
+ * @param processId The process whose page it is.
+ * @param pageNumber The virtual page number.
+ */
+void Tlb::invalidate(int processId, long pageNumber)
+{
+  if (numEntries == 0 or (not asidTagging and processId != currentProcessId))
+  {
+    return;
+  }
+
+  uint64_t key = makeKey(processId, pageNumber);
+  int first = (pageNumber & (numSets - 1)) * ways;
+  for (int entry = first; entry < first + ways; entry++)
+  {
+    if (keys[entry] == key)
+    {
+      keys[entry] = EMPTY_TLB_ENTRY;
+      lastUsed[entry] = 0;
+    }
+  }
+}
+
+
+/** hits
+ * @returns long The number of TLB hits.
+ */
+long Tlb::getHits() const
+{
+  return hits;
+}
+
+
+/** misses
+ * @returns long The number of TLB misses.
+ */
+long Tlb::getMisses() const
+{
+  return misses;
+}
+
+
+/** flushes
+ * @returns long The number of times the whole TLB was flushed.
+ */
+long Tlb::getFlushes() const
+{
+  return flushes;
+}
+
+
+/** hit rate
+ * @returns double The fraction of lookups that hit.
+ */
+double Tlb::getHitRate() const
+{
+  long lookups = hits + misses;
+  return (lookups == 0) ? 0.0 : double(hits) / lookups;
+}
@@ -0,0 +1,74 @@
+/** @file Tlb.hpp
+ * @brief A model of a translation lookaside buffer.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * The TLB caches recent page translations so that most references
+ * do not need a page table walk.  It is organized like a hardware
+ * TLB, as a number of sets each holding a few entries (ways), with
+ * least recently used replacement within a set.  The number of pages
+ * the TLB can translate at once, its reach, is what makes huge pages
+ * and loop order matter to translation cost.
+ *
+ * Entries can optionally be tagged with an address space id (ASID),
+ * the process id, so that translations of different processes can be
+ * in the TLB at the same time.  Without ASIDs the whole TLB has to be
+ * flushed whenever a reference is made by a different process than
+ * the previous reference.
+ */
+#ifndef TLB_HPP
+#define TLB_HPP
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/// default number of ways (entries per set) of the TLB
+const int DEFAULT_TLB_WAYS = 4;
+
+/** @class Tlb
+ * @brief A set associative TLB
+ *
+ * The entries of all sets are kept in flat arrays, the entries of set
+ * s are at s * ways to s * ways + ways - 1.  Each entry holds a key
+ * made from the ASID and page number, and the time it was last used.
+ */
+class Tlb
+{
+private:
+  int numEntries;
+  int ways;
+  int numSets;
+  bool asidTagging;
+
+  vector<uint64_t> keys;
+  vector<uint64_t> lastUsed;
+  uint64_t time;
+  int currentProcessId;
+
+  long hits;
+  long misses;
+  long flushes;
+
+  uint64_t makeKey(int processId, long pageNumber) const;
+  void flush();
+
+public:
+  Tlb();
+  void configure(int numEntries, int ways, bool asidTagging);
+  void reset();
+  int getNumEntries() const;
+  int getWays() const;
+  bool getAsidTagging() const;
+  bool lookup(int processId, long pageNumber);
+  void invalidate(int processId, long pageNumber);
+  long getHits() const;
+  long getMisses() const;
+  long getFlushes() const;
+  double getHitRate() const;
+};
+
+#endif // TLB_HPP
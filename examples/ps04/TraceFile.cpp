@@ -0,0 +1,455 @@
+/** @file TraceFile.cpp
+ * @brief Compact binary page reference trace files.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the trace file reader and writer.  See
+ * TraceFile.hpp for a description of the trace file format.
+ */
+#include "TraceFile.hpp"
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/// size of the buffer references are encoded into before writing
+const size_t TRACE_BUFFER_SIZE = 1 << 20;
+/// the most bytes a single encoded reference can take, 2 varints
+const size_t MAX_REFERENCE_BYTES = 20;
+
+/** constructor
+ * Create a new trace file, replacing any existing file of the same
+ * name.
+ *
+ * @param fileName The name of the trace file to write.
+ * @param flags TRACE_ELEMENT_REFERENCES to write element references,
+ *   0 to write page references.
+ * @param pageSizeBytes The page size, needed to replay the element
+ *   references of an element trace.
+ */
+TraceWriter::TraceWriter(const string& fileName, uint64_t flags, int pageSizeBytes)
+{
+  this->fileName = fileName;
+  this->flags = flags;
+  this->pageSizeBytes = pageSizeBytes;
+  file = fopen(fileName.c_str(), "wb");
+  if (file == NULL)
+  {
+    cerr << "Error: TraceWriter could not create trace file: " << fileName << endl;
+    exit(1);
+  }
+
+  buffer.resize(TRACE_BUFFER_SIZE);
+  bufferUsed = 0;
+  headerWritten = false;
+  numReferences = 0;
+}
+
+
+/** destructor
+ * Make sure everything written ends up in the file.
+ */
+TraceWriter::~TraceWriter()
+{
+  close();
+}
+
+
+/** add process
+ * Add a process to the trace.  All processes must be added before
+ * any references are written.
+ *
+ * @param name The name of the process.
+ * @param numPages The number of virtual pages in the address space
+ *   of the process.
+ * @param elementBytes The size of the matrix elements of the
+ *   process, only needed for element traces.
+ *
+ * @returns int The process id of the new process in the trace.
+ */
+int TraceWriter::addProcess(const string& name, int numPages, int elementBytes)
+{
+  if (headerWritten)
+  {
+    cerr << "Error: TraceWriter::addProcess() processes must be added to " << fileName << endl
+         << "   before any references are written" << endl;
+    exit(1);
+  }
+
+  TraceProcess process = {name, numPages, elementBytes};
+  processes.push_back(process);
+  lastPosition.push_back(0);
+  return processes.size() - 1;
+}
+
+
+/** put varint
+ * Encode a varint into the buffer.  There must be room for it.
+ *
+ * @param value The value to encode.
+ */
+void TraceWriter::putVarint(uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    buffer[bufferUsed++] = uint8_t(value) | 0x80;
+    value >>= 7;
+  }
+  buffer[bufferUsed++] = uint8_t(value);
+}
+
+
+/** write header
+ * Encode the trace header into the (empty) buffer.
+ */
+void TraceWriter::writeHeader()
+{
+  memcpy(&buffer[0], TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  bufferUsed = sizeof(TRACE_MAGIC);
+  putVarint(TRACE_VERSION);
+  putVarint(flags);
+  if (flags & TRACE_ELEMENT_REFERENCES)
+  {
+    putVarint(pageSizeBytes);
+  }
+  putVarint(processes.size());
+  for (const TraceProcess& process : processes)
+  {
+    if (bufferUsed + process.name.size() + MAX_REFERENCE_BYTES > buffer.size())
+    {
+      flushBuffer();
+    }
+    putVarint(process.numPages);
+    putVarint(process.name.size());
+    memcpy(&buffer[bufferUsed], process.name.data(), process.name.size());
+    bufferUsed += process.name.size();
+    if (flags & TRACE_ELEMENT_REFERENCES)
+    {
+      putVarint(process.elementBytes);
+    }
+  }
+  headerWritten = true;
+}
+
+
+/** flush buffer
+ * Write out everything in the buffer to the file.
+ */
+void TraceWriter::flushBuffer()
+{
+  if (bufferUsed > 0 and fwrite(&buffer[0], 1, bufferUsed, file) != bufferUsed)
+  {
+    cerr << "Error: TraceWriter failed writing to trace file: " << fileName << endl;
+    exit(1);
+  }
+  bufferUsed = 0;
+}
+
+
+/** write reference
+ * Append a page reference to the trace.
+ *
+ * @param reference The reference to write, its process must have
+ *   been added to the trace.
+ */
+void TraceWriter::write(const PageReference& reference)
+{
+  if (flags & TRACE_ELEMENT_REFERENCES)
+  {
+    cerr << "Error: TraceWriter::write() can not write a page reference to element trace " << fileName << endl;
+    exit(1);
+  }
+  if (not headerWritten)
+  {
+    writeHeader();
+  }
+  if (bufferUsed + MAX_REFERENCE_BYTES > buffer.size())
+  {
+    flushBuffer();
+  }
+
+  int64_t delta = int64_t(reference.pageNumber) - lastPosition[reference.processId];
+  lastPosition[reference.processId] = reference.pageNumber;
+  putVarint(reference.processId);
+  putVarint((uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+  numReferences++;
+}
+
+
+/** write element reference
+ * Append an element reference to the trace.
+ *
+ * @param reference The reference to write, its process must have
+ *   been added to the trace.
+ */
+void TraceWriter::write(const ElementReference& reference)
+{
+  if (not(flags & TRACE_ELEMENT_REFERENCES))
+  {
+    cerr << "Error: TraceWriter::write() can not write an element reference to page trace " << fileName << endl;
+    exit(1);
+  }
+  if (not headerWritten)
+  {
+    writeHeader();
+  }
+  if (bufferUsed + MAX_REFERENCE_BYTES > buffer.size())
+  {
+    flushBuffer();
+  }
+
+  int64_t delta = int64_t(reference.offset) - lastPosition[reference.processId];
+  lastPosition[reference.processId] = reference.offset;
+  putVarint((uint64_t(reference.processId) << 1) | (reference.isWrite ? 1 : 0));
+  putVarint((uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+  numReferences++;
+}
+
+
+/** close
+ * Write out anything still buffered and close the trace file.  It is
+ * safe to close more than once.
+ */
+void TraceWriter::close()
+{
+  if (file == NULL)
+  {
+    return;
+  }
+
+  if (not headerWritten)
+  {
+    writeHeader();
+  }
+  flushBuffer();
+  if (fclose(file) != 0)
+  {
+    cerr << "Error: TraceWriter failed closing trace file: " << fileName << endl;
+    exit(1);
+  }
+  file = NULL;
+}
+
+
+/** number of references
+ * @returns long The number of references written so far.
+ */
+long TraceWriter::getNumReferences() const
+{
+  return numReferences;
+}
+
+
+/** constructor
+ * Open and memory map a trace file, and read its header.
+ *
+ * @param fileName The name of the trace file to read.
+ */
+TraceReader::TraceReader(const string& fileName)
+{
+  this->fileName = fileName;
+  int fd = open(fileName.c_str(), O_RDONLY);
+  struct stat status;
+  if (fd < 0 or fstat(fd, &status) != 0)
+  {
+    cerr << "Error: TraceReader could not open trace file: " << fileName << endl;
+    exit(1);
+  }
+
+  size = status.st_size;
+  if (size < sizeof(TRACE_MAGIC))
+  {
+    ::close(fd);
+    data = NULL;
+    corrupt("file too short");
+  }
+  void* mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED)
+  {
+    cerr << "Error: TraceReader could not map trace file: " << fileName << endl;
+    exit(1);
+  }
+
+  // we read the trace front to back, so let the kernel read ahead
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  data = static_cast<const uint8_t*>(mapped);
+  cursor = data;
+  end = data + size;
+
+  // the header, magic and version first
+  if (memcmp(data, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0)
+  {
+    corrupt("not a trace file");
+  }
+  cursor += sizeof(TRACE_MAGIC);
+  uint64_t version = getVarint();
+  if (version != 1 and version != TRACE_VERSION)
+  {
+    corrupt("unsupported trace format version");
+  }
+  flags = (version == 1) ? 0 : getVarint();
+  bool elements = flags & TRACE_ELEMENT_REFERENCES;
+  uint64_t pageSize = elements ? getVarint() : 0;
+  if (elements and (pageSize == 0 or pageSize > INT_MAX or (pageSize & (pageSize - 1)) != 0))
+  {
+    corrupt("page size is not a power of 2");
+  }
+  pageSizeBytes = pageSize;
+
+  // then the process descriptions
+  uint64_t numProcesses = getVarint();
+  for (uint64_t processId = 0; processId < numProcesses; processId++)
+  {
+    TraceProcess process;
+    uint64_t numPages = getVarint();
+    if (numPages < 1 or numPages > INT_MAX)
+    {
+      corrupt("invalid number of pages of a process");
+    }
+    process.numPages = numPages;
+    uint64_t nameLength = getVarint();
+    if (nameLength > uint64_t(end - cursor))
+    {
+      corrupt("truncated process name");
+    }
+    process.name.assign(reinterpret_cast<const char*>(cursor), nameLength);
+    cursor += nameLength;
+    uint64_t elementBytes = elements ? getVarint() : 0;
+    if (elements and (elementBytes == 0 or elementBytes > INT_MAX))
+    {
+      corrupt("invalid element size of a process");
+    }
+    process.elementBytes = elementBytes;
+    processes.push_back(process);
+    numPositions.push_back(elements ? long(numPages) * pageSize / elementBytes : long(numPages));
+  }
+
+  firstReference = cursor;
+  lastPosition.assign(processes.size(), 0);
+}
+
+
+/** destructor
+ * Unmap the trace file.
+ */
+TraceReader::~TraceReader()
+{
+  if (data != NULL)
+  {
+    munmap(const_cast<uint8_t*>(data), size);
+  }
+}
+
+
+/** corrupt trace
+ * Report that the trace file can not be read and exit.
+ *
+ * @param reason What is wrong with the trace file.
+ */
+void TraceReader::corrupt(const string& reason)
+{
+  cerr << "Error: TraceReader bad trace file: " << fileName << endl << "   " << reason << endl;
+  exit(1);
+}
+
+
+/** get processes
+ * @returns const vector<TraceProcess>& The processes of the trace,
+ *   indexed by process id.
+ */
+const vector<TraceProcess>& TraceReader::getProcesses() const
+{
+  return processes;
+}
+
+
+/** has element references
+ * @returns bool True if this is a trace of matrix element references,
+ *   false if it is a trace of page references.
+ */
+bool TraceReader::hasElementReferences() const
+{
+  return flags & TRACE_ELEMENT_REFERENCES;
+}
+
+
+/** get page size
+ * @returns int The page size element references are translated to
+ *   pages with, 0 for traces of page references.
+ */
+int TraceReader::getPageSize() const
+{
+  return pageSizeBytes;
+}
+
+
+/** set page size
+ * Translate the element references of the trace to pages of a
+ * different size than the one it was recorded with.  The number of
+ * pages of each process becomes however many of the new pages its
+ * address space takes up.
+ *
+ * @param pageSizeBytes The page size to translate to, a power of 2.
+ */
+void TraceReader::setPageSize(int pageSizeBytes)
+{
+  if (not(flags & TRACE_ELEMENT_REFERENCES))
+  {
+    cerr << "Error: TraceReader::setPageSize() the page size of a trace of" << endl
+         << "   page references can not be changed: " << fileName << endl;
+    exit(1);
+  }
+
+  for (TraceProcess& process : processes)
+  {
+    long addressSpaceBytes = long(process.numPages) * this->pageSizeBytes;
+    long numPages = (addressSpaceBytes + pageSizeBytes - 1) / pageSizeBytes;
+    if (numPages > INT_MAX)
+    {
+      cerr << "Error: TraceReader::setPageSize() process " << process.name << " of trace " << fileName << endl
+           << "   can not be replayed with " << pageSizeBytes << " byte pages" << endl;
+      exit(1);
+    }
+    process.numPages = numPages;
+  }
+  this->pageSizeBytes = pageSizeBytes;
+}
+
+
+/** rewind
+ * Start reading the references over from the beginning.
+ */
+void TraceReader::rewind()
+{
+  cursor = firstReference;
+  lastPosition.assign(processes.size(), 0);
+}
+
+
+/** read all
+ * Read all of the (remaining) references of the trace into memory.
+ * Only sensible for traces that fit in memory, this is needed for
+ * the OPT replacement policy.
+ *
+ * @returns vector<PageReference> The references.
+ */
+vector<PageReference> TraceReader::readAll()
+{
+  vector<PageReference> references;
+  PageReference reference;
+  while (next(reference))
+  {
+    references.push_back(reference);
+  }
+  return references;
+}
@@ -0,0 +1,303 @@
+/** @file TraceFile.hpp
+ * @brief Compact binary page reference trace files.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Reading and writing of page reference traces, so that recorded
+ * reference strings can be replayed through the paging simulator.
+ * Traces can hold billions of references, so they use a compact
+ * binary format.  A trace file is a header followed by the
+ * references:
+ *
+ *   - 8 byte magic "PS04TRC" followed by a 0 byte
+ *   - varint format version, currently 2
+ *   - varint flags, TRACE_ELEMENT_REFERENCES if the trace holds
+ *     matrix element references rather than page references, and
+ *     if so the varint page size in bytes
+ *   - varint number of processes, then for each process a varint
+ *     number of pages in its address space, a varint name length
+ *     and the name bytes, and for element traces the varint size of
+ *     a matrix element in bytes
+ *   - the references.  A page reference is a varint process id
+ *     followed by the zigzag varint encoded difference between the
+ *     page number and the previous page number referenced by the
+ *     same process.  An element reference is a varint of the
+ *     process id shifted left 1 bit with the low bit set for a
+ *     write, followed by the zigzag varint encoded difference
+ *     between the offset of the element in the matrix storage and
+ *     the previous offset referenced by the same process.
+ *
+ * Version 1 traces have no flags, and only hold page references.
+ * Varints are the usual little endian base 128 encoding, 7 bits in
+ * each byte with the high bit set on all but the last byte.  Since
+ * processes mostly reference the same or a nearby page or element
+ * as their previous reference, most references take only 2 bytes.
+ */
+#ifndef TRACE_FILE_HPP
+#define TRACE_FILE_HPP
+#include "PageReplacementPolicy.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// magic bytes at the start of every trace file
+const char TRACE_MAGIC[8] = {'P', 'S', '0', '4', 'T', 'R', 'C', '\0'};
+/// the trace file format version we write, we can also read version 1
+const uint64_t TRACE_VERSION = 2;
+/// trace flag, the trace holds matrix element references
+const uint64_t TRACE_ELEMENT_REFERENCES = 1;
+
+/** Element reference
+ * A single reference by a process to an element of its matrix, as
+ * recorded from Matrix::getIndex.  The element is identified by its
+ * offset from the start of the matrix storage.
+ */
+struct ElementReference
+{
+  /// the id of the process (matrix) making the reference
+  int processId;
+  /// the offset of the element in the matrix storage, in elements
+  long offset;
+  /// true if the element was written, false if it was read
+  bool isWrite;
+};
+
+/** Trace process
+ * Description of one of the processes in a trace.
+ */
+struct TraceProcess
+{
+  /// the name of the process, e.g. the matrix name A
+  string name;
+  /// the number of virtual pages in the address space of the process
+  int numPages;
+  /// the size of an element in bytes, element traces only
+  int elementBytes;
+};
+
+/** @class TraceWriter
+ * @brief Write a page reference trace file
+ *
+ * All processes must be added before the first reference is
+ * written.  References are encoded into a large buffer which is
+ * written out whenever it fills, and when the writer is closed.
+ */
+class TraceWriter
+{
+private:
+  FILE* file;
+  string fileName;
+  uint64_t flags;
+  int pageSizeBytes;
+  vector<TraceProcess> processes;
+  vector<long> lastPosition;
+  vector<uint8_t> buffer;
+  size_t bufferUsed;
+  bool headerWritten;
+  long numReferences;
+
+  void writeHeader();
+  void flushBuffer();
+  void putVarint(uint64_t value);
+
+public:
+  TraceWriter(const string& fileName, uint64_t flags = 0, int pageSizeBytes = 0);
+  ~TraceWriter();
+  TraceWriter(const TraceWriter&) = delete;
+  TraceWriter& operator=(const TraceWriter&) = delete;
+  int addProcess(const string& name, int numPages, int elementBytes = 0);
+  void write(const PageReference& reference);
+  void write(const ElementReference& reference);
+  void close();
+  long getNumReferences() const;
+};
+
+/** @class TraceReader
+ * @brief Read a page reference trace file
+ *
+ * The whole trace file is memory mapped, so the references are
+ * decoded straight from the page cache with no copying or stream
+ * overhead.
+ */
+class TraceReader
+{
+private:
+  string fileName;
+  const uint8_t* data;
+  size_t size;
+  const uint8_t* cursor;
+  const uint8_t* end;
+  const uint8_t* firstReference;
+  uint64_t flags;
+  int pageSizeBytes;
+  vector<TraceProcess> processes;
+  /// the number of page numbers, or element offsets, in the address
+  /// space of each process
+  vector<long> numPositions;
+  vector<long> lastPosition;
+
+  void nextPosition(int& processId, long& position, bool& isWrite);
+
+  uint64_t getVarint();
+  void corrupt(const string& reason);
+
+public:
+  TraceReader(const string& fileName);
+  ~TraceReader();
+  TraceReader(const TraceReader&) = delete;
+  TraceReader& operator=(const TraceReader&) = delete;
+  const vector<TraceProcess>& getProcesses() const;
+  bool hasElementReferences() const;
+  int getPageSize() const;
+  void setPageSize(int pageSizeBytes);
+  bool next(PageReference& reference);
+  bool next(PageReference& reference, bool& isWrite);
+  bool next(ElementReference& reference);
+  void rewind();
+  vector<PageReference> readAll();
+};
+
+
+/** get varint
+ * Decode the next varint from the trace.
+ *
+ * @returns uint64_t The decoded value.
+ */
+inline uint64_t TraceReader::getVarint()
+{
+  uint64_t value = 0;
+  int shift = 0;
+  while (cursor < end)
+  {
+    uint8_t byte = *cursor++;
+    value |= uint64_t(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return value;
+    }
+    shift += 7;
+    if (shift > 63)
+    {
+      break;
+    }
+  }
+
+  corrupt("truncated or invalid varint");
+  return 0;
+}
+
+
+/** next position
+ * Decode the next reference of the trace, which is either a page
+ * number or an element offset, depending on the kind of trace.
+ *
+ * @param processId Returns the process making the reference.
+ * @param position Returns the page number or element offset.
+ * @param isWrite Returns if the reference is a write, page
+ *   references are always reads.
+ */
+inline void TraceReader::nextPosition(int& processId, long& position, bool& isWrite)
+{
+  uint64_t processWord = getVarint();
+  bool elements = flags & TRACE_ELEMENT_REFERENCES;
+  uint64_t process = elements ? (processWord >> 1) : processWord;
+  if (process >= lastPosition.size())
+  {
+    corrupt("reference to unknown process");
+  }
+
+  uint64_t zigzag = getVarint();
+  int64_t delta = int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+  position = lastPosition[process] + delta;
+  lastPosition[process] = position;
+  processId = process;
+  isWrite = elements and (processWord & 1);
+}
+
+
+/** next reference
+ * Decode the next reference of the trace as a page reference.  For
+ * element traces the offset of the element is translated to the page
+ * it is on.  This is called for every reference replayed, so it is
+ * defined inline here.
+ *
+ * @param reference Returns the next reference of the trace.
+ *
+ * @returns bool True if a reference was read, false at the end of
+ *   the trace.
+ */
+inline bool TraceReader::next(PageReference& reference)
+{
+  bool isWrite;
+  return next(reference, isWrite);
+}
+
+
+/** next reference
+ * Decode the next reference of the trace as a page reference, and
+ * whether it was a write.
+ *
+ * @param reference Returns the next reference of the trace.
+ * @param isWrite Returns true if the reference was a write, page
+ *   traces only have reads.
+ *
+ * @returns bool True if a reference was read, false at the end of
+ *   the trace.
+ */
+inline bool TraceReader::next(PageReference& reference, bool& isWrite)
+{
+  if (cursor >= end)
+  {
+    return false;
+  }
+
+  long position;
+  nextPosition(reference.processId, position, isWrite);
+  if (position < 0 or position >= numPositions[reference.processId])
+  {
+    corrupt("reference outside of process address space");
+  }
+  if (flags & TRACE_ELEMENT_REFERENCES)
+  {
+    position = position * processes[reference.processId].elementBytes / pageSizeBytes;
+  }
+
+  reference.pageNumber = position;
+  return true;
+}
+
+
+/** next element reference
+ * Decode the next reference of an element trace.
+ *
+ * @param reference Returns the next reference of the trace.
+ *
+ * @returns bool True if a reference was read, false at the end of
+ *   the trace.
+ */
+inline bool TraceReader::next(ElementReference& reference)
+{
+  if (cursor >= end)
+  {
+    return false;
+  }
+  if (not(flags & TRACE_ELEMENT_REFERENCES))
+  {
+    corrupt("not a trace of element references");
+  }
+
+  nextPosition(reference.processId, reference.offset, reference.isWrite);
+  if (reference.offset < 0 or reference.offset >= numPositions[reference.processId])
+  {
+    corrupt("reference outside of process address space");
+  }
+  return true;
+}
+
+#endif // TRACE_FILE_HPP
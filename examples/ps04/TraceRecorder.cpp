@@ -0,0 +1,252 @@
+/** @file TraceRecorder.cpp
+ * @brief Record matrix element references to a trace file.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * Implementation of the trace recorder, the slow paths of the
+ * recording threads and the background writer thread.
+ */
+#include "TraceRecorder.hpp"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+// need to initialize static member variables external to declaration
+// in class header, recorder id 0 is never used so it means no recorder,
+// and neither is STOPPED_RECORDER_ID
+atomic<uint64_t> TraceRecorder::nextRecorderId(1);
+thread_local uint64_t TraceRecorder::threadRecorderId = 0;
+thread_local RecorderThreadBuffer* TraceRecorder::threadBuffer = NULL;
+
+/** constructor
+ * Create the trace file and start the background writer thread.
+ *
+ * @param fileName The name of the trace file to record to.
+ * @param pageSizeBytes The page size, needed to replay the trace.
+ */
+TraceRecorder::TraceRecorder(const string& fileName, int pageSizeBytes)
+  : writer(fileName, TRACE_ELEMENT_REFERENCES, pageSizeBytes)
+{
+  this->pageSizeBytes = pageSizeBytes;
+  numProcesses = 0;
+  recorderId = nextRecorderId++;
+  numBlocks = 0;
+  stopping = false;
+  writerThread = thread(&TraceRecorder::writeBlocks, this);
+}
+
+
+/** destructor
+ * Stop recording if not already stopped, and free all of the blocks.
+ */
+TraceRecorder::~TraceRecorder()
+{
+  stop();
+
+  for (RecorderBlock* block : freeBlocks)
+  {
+    delete block;
+  }
+  for (RecorderThreadBuffer* buffer : threadBuffers)
+  {
+    delete buffer;
+  }
+}
+
+
+/** add process
+ * Add a process whose references will be recorded.  Processes must be
+ * added in order of their process ids starting from 0, before any
+ * references are recorded.  The process id and the element offsets
+ * of the address space must fit in a packed reference.
+ *
+ * @param processId The id of the process.
+ * @param name The name of the process.
+ * @param numPages The number of virtual pages in the address space
+ *   of the process.
+ * @param elementBytes The size of the matrix elements of the process.
+ */
+void TraceRecorder::addProcess(int processId, const string& name, int numPages, int elementBytes)
+{
+  if (processId != numProcesses)
+  {
+    cerr << "Error: TraceRecorder::addProcess() process ids must" << endl
+         << "   be added in order, expected " << numProcesses << " but got " << processId << endl;
+    exit(1);
+  }
+  if (processId >= RECORDER_MAX_PROCESSES)
+  {
+    cerr << "Error: TraceRecorder::addProcess() can record at most" << endl
+         << "   " << RECORDER_MAX_PROCESSES << " processes" << endl;
+    exit(1);
+  }
+  if (elementBytes <= 0 or long(numPages) * pageSizeBytes / elementBytes > RECORDER_MAX_ELEMENTS)
+  {
+    cerr << "Error: TraceRecorder::addProcess() the address space of process " << name << endl
+         << "   must have at most " << RECORDER_MAX_ELEMENTS << " elements" << endl;
+    exit(1);
+  }
+
+  writer.addProcess(name, numPages, elementBytes);
+  numProcesses++;
+}
+
+
+/** allocate block
+ * Get an empty block to record into, reusing blocks the writer has
+ * finished with.  If too many blocks are waiting to be written we wait
+ * for the writer to catch up, so memory use stays bounded.
+ *
+ * @param guard The held lock, released while waiting for the writer.
+ *
+ * @returns RecorderBlock* An empty block.
+ */
+RecorderBlock* TraceRecorder::allocateBlock(unique_lock<mutex>& guard)
+{
+  RecorderBlock* block;
+  if (freeBlocks.empty() and numBlocks < RECORDER_MAX_PENDING_BLOCKS + threadBuffers.size())
+  {
+    block = new RecorderBlock;
+    numBlocks++;
+  }
+  else
+  {
+    blockWritten.wait(guard, [this] { return not freeBlocks.empty(); });
+    block = freeBlocks.back();
+    freeBlocks.pop_back();
+  }
+
+  block->used = 0;
+  return block;
+}
+
+
+/** submit block
+ * Hand a block over to the writer thread.  Must be called holding
+ * the lock.
+ *
+ * @param block The block to be written.
+ */
+void TraceRecorder::submitBlock(RecorderBlock* block)
+{
+  fullBlocks.push_back(block);
+  blockFull.notify_one();
+}
+
+
+/** record slow path
+ * Called by record() when the calling thread does not have a block for
+ * this recorder yet, or its block is full.
+ *
+ * @param packed The packed reference to record.
+ */
+void TraceRecorder::recordSlow(uint64_t packed)
+{
+  unique_lock<mutex> guard(lock);
+  if (stopping)
+  {
+    cerr << "Error: TraceRecorder::record() reference recorded after recording stopped" << endl;
+    exit(1);
+  }
+
+  if (threadRecorderId != recorderId)
+  {
+    // first reference from this thread, give it a buffer
+    RecorderThreadBuffer* buffer = new RecorderThreadBuffer;
+    threadBuffers.push_back(buffer);
+    buffer->block = allocateBlock(guard);
+    threadBuffer = buffer;
+    threadRecorderId = recorderId;
+  }
+  else
+  {
+    submitBlock(threadBuffer->block);
+    threadBuffer->block = allocateBlock(guard);
+  }
+
+  RecorderBlock* block = threadBuffer->block;
+  block->references[block->used++] = packed;
+}
+
+
+/** write blocks
+ * The background writer thread.  Waits for full blocks and encodes
+ * them into the trace file, until recording is stopped and there are
+ * no more blocks to write.
+ */
+void TraceRecorder::writeBlocks()
+{
+  unique_lock<mutex> guard(lock);
+  while (true)
+  {
+    blockFull.wait(guard, [this] { return stopping or not fullBlocks.empty(); });
+    if (fullBlocks.empty())
+    {
+      break;
+    }
+    RecorderBlock* block = fullBlocks.front();
+    fullBlocks.pop_front();
+
+    // encode the block without holding the lock, so recording threads
+    // can keep handing over blocks
+    guard.unlock();
+    for (size_t index = 0; index < block->used; index++)
+    {
+      uint64_t packed = block->references[index];
+      ElementReference reference;
+      reference.processId = (packed >> 1) & 0xffff;
+      reference.offset = packed >> 17;
+      reference.isWrite = packed & 1;
+      writer.write(reference);
+    }
+    guard.lock();
+
+    freeBlocks.push_back(block);
+    blockWritten.notify_all();
+  }
+}
+
+
+/** stop recording
+ * Write out all recorded references and close the trace file.  All
+ * threads must have finished recording before this is called, their
+ * partly filled blocks are written out too.  It is safe to stop more
+ * than once.
+ */
+void TraceRecorder::stop()
+{
+  {
+    lock_guard<mutex> guard(lock);
+    if (stopping)
+    {
+      return;
+    }
+
+    for (RecorderThreadBuffer* buffer : threadBuffers)
+    {
+      submitBlock(buffer->block);
+      buffer->block = NULL;
+    }
+    stopping = true;
+    recorderId = STOPPED_RECORDER_ID;
+    blockFull.notify_one();
+  }
+
+  writerThread.join();
+  writer.close();
+}
+
+
+/** number of references
+ * Only known once recording has been stopped.
+ *
+ * @returns long The number of references written to the trace.
+ */
+long TraceRecorder::getNumReferences() const
+{
+  return writer.getNumReferences();
+}
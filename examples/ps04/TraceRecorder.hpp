@@ -0,0 +1,143 @@
+/** @file TraceRecorder.hpp
+ * @brief Record matrix element references to a trace file.
+ *
+ * @author Derek Harter
+ * @note   cwid: 123456
+ * @date   Summer 2020
+ * @note   ide:  g++ 8.2.0 / GNU Make 4.2.1
+ *
+ * The trace recorder captures every reference made through
+ * Matrix::getIndex into an element trace file, which can later be
+ * replayed through the paging simulator.  Recording has to be cheap
+ * enough that it does not disturb the references being recorded, so
+ * each recording thread appends packed references to a block of its
+ * own with no locking at all.  Only when a block fills is it handed
+ * over to a background writer thread, which encodes it into the trace
+ * file, and the thread carries on with a fresh block.
+ */
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+#include "TraceFile.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/// the number of references in a recording block, 512 KiB per block
+const size_t RECORDER_BLOCK_REFERENCES = 1 << 16;
+/// the most blocks waiting to be written before recording threads
+/// wait for the writer to catch up
+const size_t RECORDER_MAX_PENDING_BLOCKS = 64;
+/// the process ids and element offsets that fit in a packed reference
+const long RECORDER_MAX_PROCESSES = 1L << 16;
+const long RECORDER_MAX_ELEMENTS = 1L << 47;
+/// the id a recorder takes once stopped, which is never the recorder
+/// of any thread's buffer, so every later reference takes the slow path
+const uint64_t STOPPED_RECORDER_ID = UINT64_MAX;
+
+/** Recorder block
+ * A block of packed references, recorded by a single thread.  Each
+ * reference is packed in 64 bits, the element offset in the high 47
+ * bits, then the 16 bit process id, then 1 bit set for a write.
+ */
+struct RecorderBlock
+{
+  uint64_t references[RECORDER_BLOCK_REFERENCES];
+  size_t used;
+};
+
+/** Recorder thread buffer
+ * The block a thread is currently recording into.  It is only ever
+ * touched by its own thread while recording, and by stop() once all
+ * recording has finished.
+ */
+struct RecorderThreadBuffer
+{
+  RecorderBlock* block;
+};
+
+/** @class TraceRecorder
+ * @brief Record element references from any number of threads
+ *
+ * All processes must be added before the first reference is
+ * recorded.  A thread may record to only one recorder at a time.
+ */
+class TraceRecorder
+{
+private:
+  TraceWriter writer;
+  int pageSizeBytes;
+  int numProcesses;
+
+  /// unique id of this recorder, so a thread can tell its buffer
+  /// belongs to this recorder and not to an earlier one
+  uint64_t recorderId;
+  static atomic<uint64_t> nextRecorderId;
+
+  /// the recording thread's buffer, and the recorder it belongs to
+  static thread_local uint64_t threadRecorderId;
+  static thread_local RecorderThreadBuffer* threadBuffer;
+
+  /// everything below is shared with the writer thread, and is
+  /// protected by the mutex
+  mutex lock;
+  condition_variable blockFull;
+  condition_variable blockWritten;
+  deque<RecorderBlock*> fullBlocks;
+  vector<RecorderBlock*> freeBlocks;
+  vector<RecorderThreadBuffer*> threadBuffers;
+  size_t numBlocks;
+  bool stopping;
+  thread writerThread;
+
+  RecorderBlock* allocateBlock(unique_lock<mutex>& guard);
+  void submitBlock(RecorderBlock* block);
+  void recordSlow(uint64_t packed);
+  void writeBlocks();
+
+public:
+  TraceRecorder(const string& fileName, int pageSizeBytes);
+  ~TraceRecorder();
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+  void addProcess(int processId, const string& name, int numPages, int elementBytes);
+  void record(int processId, long offset, bool isWrite);
+  void stop();
+  long getNumReferences() const;
+};
+
+
+/** record reference
+ * Record a reference made by the calling thread.  This is on the path
+ * of every recorded matrix reference, so it is inline and in the
+ * common case is just a store into the thread's own block.
+ *
+ * @param processId The id of the process making the reference.
+ * @param offset The offset of the referenced element in the matrix
+ *   storage, which must be within the address space of the process.
+ * @param isWrite True if the element is written, false if read.
+ */
+inline void TraceRecorder::record(int processId, long offset, bool isWrite)
+{
+  uint64_t packed = (uint64_t(offset) << 17) | (uint64_t(processId) << 1) | (isWrite ? 1 : 0);
+
+  if (threadRecorderId == recorderId)
+  {
+    RecorderBlock* block = threadBuffer->block;
+    if (block->used < RECORDER_BLOCK_REFERENCES)
+    {
+      block->references[block->used++] = packed;
+      return;
+    }
+  }
+
+  recordSlow(packed);
+}
+
+#endif // TRACE_RECORDER_HPP
@@ -9,16 +9,202 @@
  * Simulation of the page faulting problem given for problem set 
  * 04, question #3.
  */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentPagingSimulator.hpp"
+#include "MappedMemory.hpp"
 #include "Matrix.hpp"
+#include "MatrixKernels.hpp"
+#include "TraceFile.hpp"
+#include "TraceRecorder.hpp"
 
 using namespace std;
 
 
-/// In the problem size is defined as a global constant, we use
-/// global const int as a more C++ey way to express the same thing
-const int SIZE = 64;
+/// In the problem size is defined as a global constant of 64, we
+/// allow a different size to be given on the command line
+int SIZE = 64;
+
+/// What to do with the matrix operations
+enum Mode
+{
+  RUN_MODE,        // run the buggy and fixed matrix operations
+  MAKE_TRACE_MODE, // write the reference string of the matrix operations to a trace
+  RECORD_MODE,     // record the references of the matrix operations to a trace
+  REPLAY_MODE,     // replay a trace instead of the matrix operations
+  KERNEL_MODE,     // run the tiled matrix kernels instead of the matrix operations
+  MEASURE_MODE,    // measure the real page faults of the matrix operations
+  SHARE_MODE,      // run the matrix operations in workers sharing the matrices copy on write
+  BATCH_MODE,      // run the matrix operations element by element and by row or column ranges
+  SWEEP_MODE       // simulate the matrix operations for every configuration of a grid, writing CSV
+};
+
+/// One configuration of a parameter sweep
+struct SweepConfiguration
+{
+  int size;
+  long pageSizeBytes;
+  int numFrames;
+  string policyName;
+  LoopOrder loopOrder;
+};
+
+/// The results of simulating one configuration of a parameter sweep
+struct SweepResult
+{
+  long numReferences;
+  long pageFaults;
+  long writeBacks;
+  double effectiveAccessNanoseconds;
+  double simulatedSeconds;
+  double realSeconds;
+};
+
+/// the size of the tiles of the tiled matrix layout
+const int TILE_SIZE = 32;
+
+/// the number of references each process runs for in turn when the
+/// processes of a trace are replayed with load control
+const int DEFAULT_QUANTUM = 100;
+
+/// the most workers that can share the matrices, each worker has 3
+/// matrices of its own
+const int MAX_WORKERS = 100;
+
+/// Options controlling the paging simulation, set from the command line
+int numFrames = DEFAULT_NUM_FRAMES;
+string policyName = "lru";
+string elementTypeName = "int";
+string layoutName = "row";
+Mode mode = RUN_MODE;
+string traceFileName;
+LoopOrder traceLoopOrder = ROW_MAJOR_LOOP;
+int tlbEntries = 0;
+int tlbWays = DEFAULT_TLB_WAYS;
+bool tlbAsidTagging = false;
+bool simulateCaches = false;
+string cacheLevels = "32K:8,256K:4,8M:16";
+int cacheLineBytes = DEFAULT_CACHE_LINE_BYTES;
+long workingSetWindow = 0;
+long workingSetInterval = 0;
+bool analyzeStackDistance = false;
+int numThreads = 0;
+int kernelTileSize = DEFAULT_KERNEL_TILE;
+bool pageSizeGiven = false;
+string prefetcherName;
+int prefetchDegree = DEFAULT_PREFETCH_DEGREE;
+bool dropPages = false;
+int numWorkers = 0;
+int numaNodes = 1;
+string numaPlacementName = "first-touch";
+long compressedTierBytes = 0;
+double loadControlRate = 0.0;
+long loadControlWindow = DEFAULT_LOAD_CONTROL_WINDOW;
+int quantum = DEFAULT_QUANTUM;
+bool displayArena = false;
+bool displayClock = false;
+CostModel costModel = DEFAULT_COST_MODEL;
+string sweepFileName;
+vector<int> sweepSizes;
+vector<long> sweepPageSizes;
+vector<int> sweepFrames;
+vector<string> sweepPolicies;
+vector<LoopOrder> sweepLoopOrders;
+
+
+/**
+ * @brief matrix operations reference string
+ *
+ * Generate the page reference string the matrix operations make
+ * when C = A + B is computed with the indicated loop order.  For
+ * each element A is referenced, then B, then C.  This is needed by
+ * the OPT replacement policy, which has to know all of the
+ * references of the simulation in advance.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param loopOrder The order the loops visit the matrix elements.
+ * @param size The number of rows and columns of the matrices.
+ * @param pageSizeBytes The size of the pages.
+ *
+ * @returns vector<PageReference> The reference string of the
+ *   matrix operations.
+ */
+template <class T, class Layout>
+vector<PageReference> matrixOperationsReferenceString(LoopOrder loopOrder, int size, long pageSizeBytes)
+{
+  vector<PageReference> referenceString;
+
+  for (int outer = 0; outer < size; outer++)
+  {
+    for (int inner = 0; inner < size; inner++)
+    {
+      int row = (loopOrder == ROW_MAJOR_LOOP) ? outer : inner;
+      int col = (loopOrder == ROW_MAJOR_LOOP) ? inner : outer;
+      long offset = Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout>::elementOffset(row, col, size, size);
+      int pageNumber = offset * sizeof(T) / pageSizeBytes;
+
+      // matrices A, B and C are processes 0, 1 and 2
+      for (int processId = 0; processId < 3; processId++)
+      {
+        PageReference reference = {processId, pageNumber};
+        referenceString.push_back(reference);
+      }
+    }
+  }
+
+  return referenceString;
+}
+
+
+/**
+ * @brief matrix operations reference string
+ *
+ * Generate the page reference string of the matrix operations with
+ * the matrix size and page size asked for on the command line.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param loopOrder The order the loops visit the matrix elements.
+ *
+ * @returns vector<PageReference> The reference string of the
+ *   matrix operations.
+ */
+template <class T, class Layout>
+vector<PageReference> matrixOperationsReferenceString(LoopOrder loopOrder)
+{
+  return matrixOperationsReferenceString<T, Layout>(loopOrder, SIZE, MatrixBase::getPager()->getPageSize());
+}
+
+
+/**
+ * @brief configure simulation
+ *
+ * Set up the paging simulator with the frames and replacement
+ * policy asked for on the command line, before running the matrix
+ * operations with the indicated loop order.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param loopOrder The order the loops will visit the matrix elements.
+ */
+template <class T, class Layout>
+void configureSimulation(LoopOrder loopOrder)
+{
+  vector<PageReference> referenceString;
+  if (policyName == "opt")
+  {
+    referenceString = matrixOperationsReferenceString<T, Layout>(loopOrder);
+  }
+
+  PageReplacementPolicy* policy = makeReplacementPolicy(policyName, referenceString);
+  MatrixBase::getPager()->configure(numFrames, policy);
+}
 
 
 /**
@@ -27,22 +213,26 @@ const int SIZE = 64;
  * This is the version of the code given initially in the problem 
  * set question.  It is buggy in the sense that it performs many
  * unneded page faults, slowing down the execution substantially.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
  */
+template <class T, class Layout>
 void buggyMatrixOperations()
 {
   cout << "Starting buggyMatrixOperations() -----------------------------------"
        << endl;
+  configureSimulation<T, Layout>(COLUMN_MAJOR_LOOP);
 
   // Create the matrices A, B and C for use.
-  Matrix A(SIZE, SIZE);
-  Matrix B(SIZE, SIZE);
-  Matrix C(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> A(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> B(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> C(SIZE, SIZE);
 
   // Test the matrix
   //B.getIndex(5, 5) = 25;
   //cout << "B[5][5] = " << B.getIndex(5, 5) << endl;
 
-  int register i, j; // loop index variables
+  int i, j; // loop index variables
 
   // outer loop over the columns
   for (j = 0; j < SIZE; j++)
@@ -66,22 +256,26 @@ void buggyMatrixOperations()
  * 
  * This version fixes paging problems, processes matrices to 
  * maximize use of loaded pages.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
  */
+template <class T, class Layout>
 void fixedMatrixOperations()
 {
   cout << "Starting fixedMatrixOperations() -----------------------------------"
        << endl;
+  configureSimulation<T, Layout>(ROW_MAJOR_LOOP);
 
   // Create the matrices A, B and C for use.
-  Matrix A(SIZE, SIZE);
-  Matrix B(SIZE, SIZE);
-  Matrix C(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> A(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> B(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> C(SIZE, SIZE);
 
   // Test the matrix
   //B.getIndex(5, 5) = 25;
   //cout << "B[5][5] = " << B.getIndex(5, 5) << endl;
 
-  int register i, j; // loop index variables
+  int i, j; // loop index variables
 
   // outer loop over the rows
   for (i = 0; i < SIZE; i++)
@@ -101,27 +295,1636 @@ void fixedMatrixOperations()
 
 
 /**
- * @brief main entry
+ * @brief make trace
  *
- * Main entry point of process when run.  Code execution starts here.
- * Whenever a process is created, it is initially created with a single
- * thread.  The main() function starting point is the code that
- * will initially be executing in the initial thread.
+ * Write the reference string of the matrix operations with the
+ * indicated loop order to a trace file, which can then be replayed
+ * with the --replay option.
  *
- * @param argc The count of the number of arguments on the command line.
- * @param argv[] An array of char* strings, the command line arguments
- *   provided by the user when this program is run.
+ * @param traceFileName The name of the trace file to write.
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param traceFileName The name of the trace file to write.
+ * @param loopOrder The order the loops visit the matrix elements.
+ */
+template <class T, class Layout>
+void makeTrace(const string& traceFileName, LoopOrder loopOrder)
+{
+  long storageBytes = Layout::storageSize(SIZE, SIZE) * sizeof(T);
+  int numPages = MatrixBase::getPager()->translateAddressToPage(storageBytes - 1) + 1;
+  TraceWriter trace(traceFileName);
+  trace.addProcess("A", numPages);
+  trace.addProcess("B", numPages);
+  trace.addProcess("C", numPages);
+
+  for (const PageReference& reference : matrixOperationsReferenceString<T, Layout>(loopOrder))
+  {
+    trace.write(reference);
+  }
+  trace.close();
+
+  cout << "Wrote " << trace.getNumReferences() << " references to trace file " << traceFileName << endl;
+}
+
+
+/**
+ * @brief record trace
  *
- * @returns int Returns a status/exit code.  0 means normal termination.
+ * Run the matrix operations with the indicated loop order, recording
+ * all of the matrix element references they make to a trace file,
+ * which can then be replayed with the --replay option.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param traceFileName The name of the trace file to record to.
+ * @param loopOrder The order the loops visit the matrix elements.
  */
-int main(int argc, char* argv[])
+template <class T, class Layout>
+void recordTrace(const string& traceFileName, LoopOrder loopOrder)
+{
+  TraceRecorder recorder(traceFileName, MatrixBase::getPager()->getPageSize());
+  MatrixBase::setRecorder(&recorder);
+
+  if (loopOrder == COLUMN_MAJOR_LOOP)
+  {
+    buggyMatrixOperations<T, Layout>();
+  }
+  else
+  {
+    fixedMatrixOperations<T, Layout>();
+  }
+
+  MatrixBase::setRecorder(NULL);
+  recorder.stop();
+  cout << "Recorded " << recorder.getNumReferences() << " references to trace file " << traceFileName << endl;
+}
+
+
+/**
+ * @brief set replay page size
+ *
+ * Element traces are replayed with the page size given by --page-size,
+ * or if none was given with the page size they were recorded with.
+ * Page traces can only be replayed with the pages they hold.
+ *
+ * @param trace The trace about to be replayed.
+ */
+void setReplayPageSize(TraceReader& trace)
+{
+  if (not trace.hasElementReferences())
+  {
+    return;
+  }
+  if (pageSizeGiven)
+  {
+    trace.setPageSize(MatrixBase::getPager()->getPageSize());
+  }
+  else
+  {
+    MatrixBase::getPager()->setPageSize(trace.getPageSize());
+  }
+}
+
+
+/**
+ * @brief replay trace
+ *
+ * Replay the page references of a trace file through the paging
+ * simulator, instead of generating them from the matrix operations.
+ *
+ * @param traceFileName The name of the trace file to replay.
+ */
+void replayTrace(const string& traceFileName)
+{
+  cout << "Starting replayTrace() " << traceFileName << " -----------------------------------" << endl;
+  TraceReader trace(traceFileName);
+  setReplayPageSize(trace);
+
+  // OPT needs to know the whole reference string up front
+  vector<PageReference> referenceString;
+  if (policyName == "opt")
+  {
+    referenceString = trace.readAll();
+    trace.rewind();
+  }
+
+  DynamicPagingSimulator* pager = MatrixBase::getPager();
+  pager->configure(numFrames, makeReplacementPolicy(policyName, referenceString));
+  const vector<TraceProcess>& processes = trace.getProcesses();
+  for (int processId = 0; processId < int(processes.size()); processId++)
+  {
+    pager->addProcess(processId, processes[processId].name, processes[processId].numPages);
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  long numReferences = 0;
+  PageReference reference;
+  bool isWrite;
+  while (trace.next(reference, isWrite))
+  {
+    pager->referencePage(reference.processId, reference.pageNumber, isWrite);
+    numReferences++;
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  pager->displayResults();
+  cout << "    Replayed " << numReferences << " references in " << elapsed.count() << " seconds" << endl;
+  pager->resetSimulation();
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief replay trace concurrently
+ *
+ * Replay the page references of a trace file through the concurrent
+ * paging simulator, with the processes of the trace shared out among
+ * the threads.  The trace is first decoded into the reference string
+ * of each process, so that the threads only simulate, and each thread
+ * replays the references of its processes in order.
+ *
+ * @param traceFileName The name of the trace file to replay.
+ * @param numThreads The number of threads to replay with.
+ */
+void replayTraceConcurrently(const string& traceFileName, int numThreads)
+{
+  cout << "Starting replayTraceConcurrently() " << traceFileName << " -----------------------------------" << endl;
+  TraceReader trace(traceFileName);
+  setReplayPageSize(trace);
+
+  const vector<TraceProcess>& processes = trace.getProcesses();
+  int numProcesses = processes.size();
+  if (numFrames < numProcesses)
+  {
+    cerr << "Error: replayTraceConcurrently() needs at least one frame for each of the " << numProcesses
+         << " processes" << endl;
+    exit(1);
+  }
+  ConcurrentPagingSimulator pager(numFrames, policyName);
+  for (int processId = 0; processId < numProcesses; processId++)
+  {
+    pager.addProcess(processId, processes[processId].name, processes[processId].numPages);
+  }
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  vector<vector<int>> pageReferences(numProcesses);
+  long numReferences = 0;
+  PageReference reference;
+  while (trace.next(reference))
+  {
+    pageReferences[reference.processId].push_back(reference.pageNumber);
+    numReferences++;
+  }
+  chrono::duration<double> decodeElapsed = chrono::steady_clock::now() - start;
+
+  start = chrono::steady_clock::now();
+  vector<thread> threads;
+  for (int threadId = 0; threadId < numThreads; threadId++)
+  {
+    threads.push_back(thread([&pager, &pageReferences, threadId, numThreads, numProcesses]() {
+      for (int processId = threadId; processId < numProcesses; processId += numThreads)
+      {
+        for (int pageNumber : pageReferences[processId])
+        {
+          pager.referencePage(processId, pageNumber);
+        }
+      }
+    }));
+  }
+  for (thread& replayThread : threads)
+  {
+    replayThread.join();
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  pager.displayResults();
+  cout << "    Decoded " << numReferences << " references in " << decodeElapsed.count() << " seconds" << endl
+       << "    Replayed " << numReferences << " references with " << numThreads << " threads in " << elapsed.count()
+       << " seconds" << endl;
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief replay with load control
+ *
+ * Replay the processes of a trace as a multiprogrammed system would
+ * run them, each process running a quantum of its references in turn,
+ * first without and then with load control, and compare the
+ * throughput.  Suspended processes are not run, and a process that
+ * finishes its references exits, freeing its frames.
+ *
+ * @param traceFileName The name of the trace file to replay.
+ */
+void replayWithLoadControl(const string& traceFileName)
+{
+  cout << "Starting replayWithLoadControl() " << traceFileName << " -----------------------------------" << endl;
+  TraceReader trace(traceFileName);
+  setReplayPageSize(trace);
+  const vector<TraceProcess>& processes = trace.getProcesses();
+  int numProcesses = processes.size();
+
+  vector<vector<int>> pageReferences(numProcesses);
+  vector<vector<bool>> pageWrites(numProcesses);
+  PageReference reference;
+  bool isWrite;
+  while (trace.next(reference, isWrite))
+  {
+    pageReferences[reference.processId].push_back(reference.pageNumber);
+    pageWrites[reference.processId].push_back(isWrite);
+  }
+
+  DynamicPagingSimulator* pager = MatrixBase::getPager();
+  double throughput[2];
+  for (int withLoadControl = 0; withLoadControl < 2; withLoadControl++)
+  {
+    pager->setLoadControl(withLoadControl ? loadControlWindow : 0, loadControlRate, loadControlRate / 2.0);
+    vector<PageReference> noReferences;
+    pager->configure(numFrames, makeReplacementPolicy(policyName, noReferences));
+    for (int processId = 0; processId < numProcesses; processId++)
+    {
+      pager->addProcess(processId, processes[processId].name, processes[processId].numPages);
+    }
+
+    vector<size_t> nextReference(numProcesses, 0);
+    int numFinished = 0;
+    int nextProcess = 0;
+    while (numFinished < numProcesses)
+    {
+      // the next process in turn that has references left and is not
+      // suspended, if every process left is suspended resume one
+      int processId = NO_PROCESS;
+      int suspendedId = NO_PROCESS;
+      for (int step = 0; step < numProcesses and processId == NO_PROCESS; step++)
+      {
+        int candidate = (nextProcess + step) % numProcesses;
+        if (nextReference[candidate] == pageReferences[candidate].size())
+        {
+          continue;
+        }
+        if (not pager->isSuspended(candidate))
+        {
+          processId = candidate;
+        }
+        else if (suspendedId == NO_PROCESS)
+        {
+          suspendedId = candidate;
+        }
+      }
+      if (processId == NO_PROCESS)
+      {
+        pager->resumeProcess(suspendedId);
+        continue;
+      }
+
+      for (int step = 0; step < quantum and nextReference[processId] < pageReferences[processId].size() and
+                         not pager->isSuspended(processId);
+           step++)
+      {
+        size_t index = nextReference[processId]++;
+        pager->referencePage(processId, pageReferences[processId][index], pageWrites[processId][index]);
+      }
+      if (nextReference[processId] == pageReferences[processId].size())
+      {
+        pager->exitProcess(processId);
+        numFinished++;
+      }
+      nextProcess = (processId + 1) % numProcesses;
+    }
+
+    cout << (withLoadControl ? "With" : "Without") << " load control, quantum " << quantum << " references:" << endl;
+    pager->displayResults();
+    double seconds = pager->getSimulatedSeconds();
+    throughput[withLoadControl] = (seconds == 0.0) ? 0.0 : pager->getNumReferences() / seconds;
+    cout << "    Simulated time: " << seconds << " seconds throughput: " << throughput[withLoadControl]
+         << " references per simulated second" << endl;
+  }
+
+  cout << "Throughput with load control: " << ((throughput[0] == 0.0) ? 0.0 : throughput[1] / throughput[0])
+       << " times the throughput without" << endl;
+  pager->setLoadControl(0, 1.0, 0.0);
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief measure matrix operations
+ *
+ * Run the matrix operations with the indicated loop order twice, once
+ * through the paging simulator, and once on real memory mapped from
+ * the operating system, and display the simulated page faults beside
+ * the real page faults and time.  Unless the pages are dropped first
+ * the real matrices are already resident from initializing them, so
+ * the operating system, with plenty of memory, has few faults.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param loopOrder The order the loops visit the matrix elements.
+ */
+template <class T, class Layout>
+void measureMatrixOperations(LoopOrder loopOrder)
+{
+  cout << "Starting measureMatrixOperations() " << ((loopOrder == ROW_MAJOR_LOOP) ? "row" : "column")
+       << " major loop -----------------------------------" << endl;
+
+  // the simulated operations
+  configureSimulation<T, Layout>(loopOrder);
+  long simulatedFaults;
+  {
+    Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> A(SIZE, SIZE);
+    Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> B(SIZE, SIZE);
+    Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> C(SIZE, SIZE);
+    for (int outer = 0; outer < SIZE; outer++)
+    {
+      for (int inner = 0; inner < SIZE; inner++)
+      {
+        int i = (loopOrder == ROW_MAJOR_LOOP) ? outer : inner;
+        int j = (loopOrder == ROW_MAJOR_LOOP) ? inner : outer;
+        C.getIndex(i, j) = A.getIndex(i, j) + B.getIndex(i, j);
+      }
+    }
+    simulatedFaults = MatrixBase::getPager()->getPageFaultCount();
+    A.endSimulation();
+  }
+
+  // the same operations on real memory, laid out the same way
+  long storageBytes = Layout::storageSize(SIZE, SIZE) * sizeof(T);
+  MappedArray realA(storageBytes);
+  MappedArray realB(storageBytes);
+  MappedArray realC(storageBytes);
+  T* a = static_cast<T*>(realA.getAddress());
+  T* b = static_cast<T*>(realB.getAddress());
+  T* c = static_cast<T*>(realC.getAddress());
+  T value = 1;
+  for (int i = 0; i < SIZE; i++)
+  {
+    for (int j = 0; j < SIZE; j++)
+    {
+      long offset = Layout::offset(i, j, SIZE, SIZE);
+      a[offset] = value;
+      b[offset] = value;
+      c[offset] = 0;
+      value = value + 1;
+    }
+  }
+  if (dropPages)
+  {
+    realA.dropPages();
+    realB.dropPages();
+    realC.dropPages();
+  }
+
+  FaultCounts before = getFaultCounts();
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (int outer = 0; outer < SIZE; outer++)
+  {
+    for (int inner = 0; inner < SIZE; inner++)
+    {
+      int i = (loopOrder == ROW_MAJOR_LOOP) ? outer : inner;
+      int j = (loopOrder == ROW_MAJOR_LOOP) ? inner : outer;
+      long offset = Layout::offset(i, j, SIZE, SIZE);
+      c[offset] = a[offset] + b[offset];
+    }
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  FaultCounts after = getFaultCounts();
+
+  cout << "    Page size simulated: " << MatrixBase::getPager()->getPageSize()
+       << " bytes real: " << getSystemPageSize() << " bytes" << endl
+       << "    Simulated page faults: " << simulatedFaults << " with " << numFrames << " frames" << endl
+       << "    Real page faults minor: " << after.minorFaults - before.minorFaults
+       << " major: " << after.majorFaults - before.majorFaults
+       << (dropPages ? " with pages dropped" : " with pages resident") << endl
+       << "    Real time: " << elapsed.count() << " seconds" << endl;
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief shared matrix operations
+ *
+ * Run the matrix operations in worker processes forked from the
+ * process holding A, B and C, as a server forking its workers would.
+ * Each worker maps copies of the matrices copy on write, and adds its
+ * share of the rows of A and B into its copy of C.  So A and B stay
+ * shared by all of the workers, while each worker copies the pages of
+ * C that it writes.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param loopOrder The order the loops of the workers visit the matrix elements.
+ * @param numWorkers The number of workers to share the matrices.
+ */
+template <class T, class Layout>
+void sharedMatrixOperations(LoopOrder loopOrder, int numWorkers)
+{
+  cout << "Starting sharedMatrixOperations() with " << numWorkers << " workers and "
+       << ((loopOrder == ROW_MAJOR_LOOP) ? "row" : "column") << " major loops -----------------------------------"
+       << endl;
+  vector<PageReference> noReferences;
+  MatrixBase::getPager()->configure(numFrames, makeReplacementPolicy(policyName, noReferences));
+
+  typedef Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> MatrixType;
+  MatrixType A(SIZE, SIZE);
+  MatrixType B(SIZE, SIZE);
+  MatrixType C(SIZE, SIZE);
+
+  // fork all of the workers before any of them run
+  vector<MatrixType*> workerMatrices;
+  for (int worker = 0; worker < numWorkers; worker++)
+  {
+    workerMatrices.push_back(new MatrixType(A));
+    workerMatrices.push_back(new MatrixType(B));
+    workerMatrices.push_back(new MatrixType(C));
+  }
+
+  for (int worker = 0; worker < numWorkers; worker++)
+  {
+    MatrixType& workerA = *workerMatrices[3 * worker];
+    MatrixType& workerB = *workerMatrices[3 * worker + 1];
+    MatrixType& workerC = *workerMatrices[3 * worker + 2];
+    int firstRow = worker * SIZE / numWorkers;
+    int numRows = (worker + 1) * SIZE / numWorkers - firstRow;
+    for (int outer = 0; outer < ((loopOrder == ROW_MAJOR_LOOP) ? numRows : SIZE); outer++)
+    {
+      for (int inner = 0; inner < ((loopOrder == ROW_MAJOR_LOOP) ? SIZE : numRows); inner++)
+      {
+        int i = firstRow + ((loopOrder == ROW_MAJOR_LOOP) ? outer : inner);
+        int j = (loopOrder == ROW_MAJOR_LOOP) ? inner : outer;
+        workerC.getIndex(i, j) = workerA.getIndex(i, j) + workerB.getIndex(i, j);
+      }
+    }
+  }
+
+  A.endSimulation();
+  for (MatrixType* matrix : workerMatrices)
+  {
+    delete matrix;
+  }
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief batched matrix operations
+ *
+ * Compute C = A + B with the indicated loop order twice, first
+ * element by element with getIndex(), and then a whole row or column
+ * at a time with the range accessors, which simulate the references
+ * to each range as one batch.  The results of both are displayed,
+ * with the real time the simulation of each took, to compare the
+ * overhead of simulating the references one at a time and in
+ * batches.  The range version references all of a row or column of
+ * A, then of B, then of C, so its reference string, and so its
+ * faults, differ from element by element when a row or column spans
+ * pages.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param loopOrder The order the loops visit the matrix elements.
+ */
+template <class T, class Layout>
+void batchedMatrixOperations(LoopOrder loopOrder)
+{
+  string lineName = (loopOrder == ROW_MAJOR_LOOP) ? "row" : "column";
+  typedef Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> MatrixType;
+  vector<PageReference> noReferences;
+
+  cout << "Starting batchedMatrixOperations() element by element with " << lineName
+       << " major loops -----------------------------------" << endl;
+  MatrixBase::getPager()->configure(numFrames, makeReplacementPolicy(policyName, noReferences));
+  chrono::duration<double> elementElapsed;
+  {
+    MatrixType A(SIZE, SIZE);
+    MatrixType B(SIZE, SIZE);
+    MatrixType C(SIZE, SIZE);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int outer = 0; outer < SIZE; outer++)
+    {
+      for (int inner = 0; inner < SIZE; inner++)
+      {
+        int i = (loopOrder == ROW_MAJOR_LOOP) ? outer : inner;
+        int j = (loopOrder == ROW_MAJOR_LOOP) ? inner : outer;
+        C.getIndex(i, j) = A.getIndex(i, j) + B.getIndex(i, j);
+      }
+    }
+    elementElapsed = chrono::steady_clock::now() - start;
+
+    A.endSimulation();
+    cout << "    Simulation time: " << elementElapsed.count() << " seconds" << endl;
+    cout << endl << endl;
+  }
+
+  cout << "Starting batchedMatrixOperations() by " << lineName << " ranges -----------------------------------"
+       << endl;
+  MatrixBase::getPager()->configure(numFrames, makeReplacementPolicy(policyName, noReferences));
+  chrono::duration<double> rangeElapsed;
+  {
+    MatrixType A(SIZE, SIZE);
+    MatrixType B(SIZE, SIZE);
+    MatrixType C(SIZE, SIZE);
+    vector<T> aLine(SIZE);
+    vector<T> bLine(SIZE);
+    vector<T> cLine(SIZE);
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int line = 0; line < SIZE; line++)
+    {
+      if (loopOrder == ROW_MAJOR_LOOP)
+      {
+        A.getRow(line, 0, SIZE, aLine.data());
+        B.getRow(line, 0, SIZE, bLine.data());
+      }
+      else
+      {
+        A.getCol(0, line, SIZE, aLine.data());
+        B.getCol(0, line, SIZE, bLine.data());
+      }
+
+      for (int element = 0; element < SIZE; element++)
+      {
+        cLine[element] = aLine[element] + bLine[element];
+      }
+
+      if (loopOrder == ROW_MAJOR_LOOP)
+      {
+        C.setRow(line, 0, SIZE, cLine.data());
+      }
+      else
+      {
+        C.setCol(0, line, SIZE, cLine.data());
+      }
+    }
+    rangeElapsed = chrono::steady_clock::now() - start;
+
+    A.endSimulation();
+    cout << "    Simulation time: " << rangeElapsed.count() << " seconds" << endl;
+  }
+
+  cout << "    Batched references simulated " << elementElapsed.count() / rangeElapsed.count()
+       << " times faster than element by element" << endl;
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief simulate sweep configuration
+ *
+ * Simulate the matrix operations C = A + B for one configuration of
+ * a parameter sweep, with matrices in the indicated simulation
+ * context, so that configurations can be simulated at the same time
+ * by different threads, each with a context of its own.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param configuration The configuration to simulate.
+ * @param context The simulation context to simulate in.
+ *
+ * @returns SweepResult The results of the simulation.
+ */
+template <class T, class Layout>
+SweepResult simulateSweepConfiguration(const SweepConfiguration& configuration, SimulationContext& context)
 {
-  // call the buggy version
-  buggyMatrixOperations();
-  
-  // call the buggy version
-  fixedMatrixOperations();
-  
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  int size = configuration.size;
+  vector<PageReference> referenceString;
+  if (configuration.policyName == "opt")
+  {
+    referenceString =
+      matrixOperationsReferenceString<T, Layout>(configuration.loopOrder, size, configuration.pageSizeBytes);
+  }
+
+  DynamicPagingSimulator* pager = context.getPager();
+  pager->setVerbose(false);
+  pager->setPageSize(configuration.pageSizeBytes);
+  pager->setCostModel(costModel);
+  pager->configure(configuration.numFrames, makeReplacementPolicy(configuration.policyName, referenceString));
+  {
+    Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> A(size, size, &context);
+    Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> B(size, size, &context);
+    Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> C(size, size, &context);
+
+    for (int outer = 0; outer < size; outer++)
+    {
+      for (int inner = 0; inner < size; inner++)
+      {
+        int i = (configuration.loopOrder == ROW_MAJOR_LOOP) ? outer : inner;
+        int j = (configuration.loopOrder == ROW_MAJOR_LOOP) ? inner : outer;
+        C.getIndex(i, j) = A.getIndex(i, j) + B.getIndex(i, j);
+      }
+    }
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  SweepResult result = {pager->getNumReferences(),           pager->getPageFaultCount(),
+                        pager->getWriteBackCount(),           pager->getEffectiveAccessNanoseconds(),
+                        pager->getSimulatedSeconds(),         elapsed.count()};
+  context.resetSimulation();
+  return result;
+}
+
+
+/**
+ * @brief sweep matrix operations
+ *
+ * Simulate the matrix operations for every combination of the matrix
+ * sizes, page sizes, frame counts, policies and loop orders of the
+ * sweep, sharing the configurations out among a pool of threads,
+ * each simulating in a simulation context of its own, and write the
+ * results of each to a CSV file, in the order of the grid.  Each
+ * configuration is simulated with plain demand paging.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param fileName The name of the CSV file to write.
+ * @param numThreads The number of threads to simulate with, 0 for
+ *   one for each core.
+ */
+template <class T, class Layout>
+void sweepMatrixOperations(const string& fileName, int numThreads)
+{
+  cout << "Starting sweepMatrixOperations() " << fileName << " -----------------------------------" << endl;
+  ofstream csv(fileName);
+  if (not csv)
+  {
+    cerr << "Error: sweepMatrixOperations() could not open " << fileName << " for writing" << endl;
+    exit(1);
+  }
+
+  vector<SweepConfiguration> configurations;
+  for (int size : sweepSizes)
+  {
+    for (long pageSizeBytes : sweepPageSizes)
+    {
+      for (int frames : sweepFrames)
+      {
+        for (const string& policy : sweepPolicies)
+        {
+          for (LoopOrder loopOrder : sweepLoopOrders)
+          {
+            SweepConfiguration configuration = {size, pageSizeBytes, frames, policy, loopOrder};
+            configurations.push_back(configuration);
+          }
+        }
+      }
+    }
+  }
+
+  if (numThreads == 0)
+  {
+    numThreads = max(1u, thread::hardware_concurrency());
+  }
+
+  // each thread takes the next configuration no thread has taken yet,
+  // until there are none left
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  vector<SweepResult> results(configurations.size());
+  atomic<long> nextConfiguration(0);
+  vector<thread> threads;
+  for (int threadId = 0; threadId < numThreads; threadId++)
+  {
+    threads.push_back(thread([&configurations, &results, &nextConfiguration]() {
+      SimulationContext context;
+      long configuration;
+      while ((configuration = nextConfiguration++) < long(configurations.size()))
+      {
+        results[configuration] = simulateSweepConfiguration<T, Layout>(configurations[configuration], context);
+      }
+    }));
+  }
+  for (thread& sweepThread : threads)
+  {
+    sweepThread.join();
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  csv << "size,page_size,frames,policy,loop_order,references,page_faults,write_backs,fault_rate,"
+      << "effective_access_ns,simulated_seconds,real_seconds" << "\n";
+  for (size_t configuration = 0; configuration < configurations.size(); configuration++)
+  {
+    const SweepConfiguration& sweep = configurations[configuration];
+    const SweepResult& result = results[configuration];
+    csv << sweep.size << "," << sweep.pageSizeBytes << "," << sweep.numFrames << "," << sweep.policyName << ","
+        << ((sweep.loopOrder == ROW_MAJOR_LOOP) ? "row" : "column") << "," << result.numReferences << ","
+        << result.pageFaults << "," << result.writeBacks << "," << double(result.pageFaults) / result.numReferences
+        << "," << result.effectiveAccessNanoseconds << "," << result.simulatedSeconds << "," << result.realSeconds
+        << "\n";
+  }
+  csv.close();
+
+  cout << "    Simulated " << configurations.size() << " configurations with " << numThreads << " threads in "
+       << elapsed.count() << " seconds" << endl
+       << "    Wrote the results to " << fileName << endl;
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief run kernel
+ *
+ * Run one of the tiled matrix kernels on new matrices, with the tiles
+ * visited in the indicated loop order, and display the simulated page
+ * faults and the real time the kernel took.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ * @param kernelName The kernel to run, add, multiply or transpose.
+ * @param loopOrder The order the kernel visits the tiles.
+ */
+template <class T, class Layout>
+void runKernel(const string& kernelName, LoopOrder loopOrder)
+{
+  cout << "Starting " << kernelName << " kernel with " << ((loopOrder == ROW_MAJOR_LOOP) ? "row" : "column")
+       << " major tile order -----------------------------------" << endl;
+  vector<PageReference> noReferences;
+  MatrixBase::getPager()->configure(numFrames, makeReplacementPolicy(policyName, noReferences));
+
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> A(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> B(SIZE, SIZE);
+  Matrix<T, DYNAMIC_SIZE, DYNAMIC_SIZE, Layout> C(SIZE, SIZE);
+
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  if (kernelName == "add")
+  {
+    addKernel(C, A, B, loopOrder, kernelTileSize);
+  }
+  else if (kernelName == "multiply")
+  {
+    multiplyKernel(C, A, B, loopOrder, kernelTileSize);
+  }
+  else
+  {
+    transposeKernel(C, A, loopOrder, kernelTileSize);
+  }
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  A.endSimulation();
+  cout << "    Kernel time: " << elapsed.count() << " seconds" << endl;
+  cout << endl << endl;
+}
+
+
+/**
+ * @brief run matrix operations
+ *
+ * Run the matrix operations, or trace or record them, as asked for on
+ * the command line, with matrices of the indicated element type and
+ * layout.
+ *
+ * @tparam T, Layout The element type and layout of the matrices.
+ */
+template <class T, class Layout>
+void runMatrixOperations()
+{
+  if (mode == MAKE_TRACE_MODE)
+  {
+    makeTrace<T, Layout>(traceFileName, traceLoopOrder);
+  }
+  else if (mode == RECORD_MODE)
+  {
+    recordTrace<T, Layout>(traceFileName, traceLoopOrder);
+  }
+  else if (mode == MEASURE_MODE)
+  {
+    measureMatrixOperations<T, Layout>(COLUMN_MAJOR_LOOP);
+    measureMatrixOperations<T, Layout>(ROW_MAJOR_LOOP);
+  }
+  else if (mode == SHARE_MODE)
+  {
+    sharedMatrixOperations<T, Layout>(COLUMN_MAJOR_LOOP, numWorkers);
+    sharedMatrixOperations<T, Layout>(ROW_MAJOR_LOOP, numWorkers);
+  }
+  else if (mode == SWEEP_MODE)
+  {
+    sweepMatrixOperations<T, Layout>(sweepFileName, numThreads);
+  }
+  else if (mode == BATCH_MODE)
+  {
+    batchedMatrixOperations<T, Layout>(COLUMN_MAJOR_LOOP);
+    batchedMatrixOperations<T, Layout>(ROW_MAJOR_LOOP);
+  }
+  else if (mode == KERNEL_MODE)
+  {
+    LoopOrder loopOrders[] = {COLUMN_MAJOR_LOOP, ROW_MAJOR_LOOP};
+    string kernelNames[] = {"add", "multiply", "transpose"};
+    for (LoopOrder loopOrder : loopOrders)
+    {
+      for (const string& kernelName : kernelNames)
+      {
+        runKernel<T, Layout>(kernelName, loopOrder);
+      }
+    }
+  }
+  else
+  {
+    // call the buggy version
+    buggyMatrixOperations<T, Layout>();
+
+    // call the fixed version
+    fixedMatrixOperations<T, Layout>();
+  }
+}
+
+
+/**
+ * @brief run with layout
+ *
+ * Run the matrix operations with matrices of the indicated element
+ * type, and the layout asked for on the command line.
+ *
+ * @tparam T The element type of the matrices.
+ *
+ * @returns bool False if the layout is not known.
+ */
+template <class T>
+bool runWithLayout()
+{
+  if (layoutName == "row")
+  {
+    runMatrixOperations<T, RowMajor>();
+  }
+  else if (layoutName == "column")
+  {
+    runMatrixOperations<T, ColumnMajor>();
+  }
+  else if (layoutName == "tiled")
+  {
+    runMatrixOperations<T, Tiled<TILE_SIZE, TILE_SIZE>>();
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * @brief parse size
+ *
+ * Parse a size given on the command line, which may have a K, M or G
+ * suffix for KiB, MiB or GiB, e.g. 4K or 2M.
+ *
+ * @param size The size to parse.
+ *
+ * @returns long The size, or 0 if it is not a valid size.
+ */
+long parseSize(const string& size)
+{
+  char* suffix;
+  long value = strtol(size.c_str(), &suffix, 10);
+  string units = suffix;
+
+  if (units == "K" or units == "k")
+  {
+    value *= 1024L;
+  }
+  else if (units == "M" or units == "m")
+  {
+    value *= 1024L * 1024L;
+  }
+  else if (units == "G" or units == "g")
+  {
+    value *= 1024L * 1024L * 1024L;
+  }
+  else if (not units.empty())
+  {
+    return 0;
+  }
+
+  return value;
+}
+
+
+/**
+ * @brief valid page size
+ *
+ * @param pageSizeBytes A page size given on the command line.
+ *
+ * @returns bool True if the page size is a power of two that holds
+ *   at least one element and the simulator can translate.
+ */
+bool validPageSize(long pageSizeBytes)
+{
+  return pageSizeBytes >= long(sizeof(int)) and pageSizeBytes <= (1L << 30) and
+         (pageSizeBytes & (pageSizeBytes - 1)) == 0;
+}
+
+
+/**
+ * @brief split list
+ *
+ * Split a comma separated list given on the command line, e.g. the
+ * values of a parameter of a sweep.
+ *
+ * @param list The list to split.
+ *
+ * @returns vector<string> The items of the list.
+ */
+vector<string> splitList(const string& list)
+{
+  vector<string> items;
+  istringstream stream(list);
+  string item;
+  while (getline(stream, item, ','))
+  {
+    items.push_back(item);
+  }
+  return items;
+}
+
+
+/**
+ * @brief parse costs
+ *
+ * Set the costs of the cost model given on the command line as a
+ * comma separated list of name=nanoseconds, where the names are hit,
+ * tlb-miss, minor, disk and tier, e.g. hit=80,disk=100000.  Costs not
+ * given are left as they are.
+ *
+ * @param list The list of costs.
+ * @param costs The cost model to set the costs of.
+ *
+ * @returns bool True if every cost in the list is valid.
+ */
+bool parseCosts(const string& list, CostModel& costs)
+{
+  for (const string& item : splitList(list))
+  {
+    size_t equals = item.find('=');
+    if (equals == string::npos)
+    {
+      return false;
+    }
+    string name = item.substr(0, equals);
+    double nanoseconds = atof(item.substr(equals + 1).c_str());
+    if (nanoseconds < 0.0)
+    {
+      return false;
+    }
+
+    if (name == "hit")
+    {
+      costs.hitNanoseconds = nanoseconds;
+    }
+    else if (name == "tlb-miss")
+    {
+      costs.tlbMissNanoseconds = nanoseconds;
+    }
+    else if (name == "minor")
+    {
+      costs.minorFaultNanoseconds = nanoseconds;
+    }
+    else if (name == "disk")
+    {
+      costs.diskNanoseconds = nanoseconds;
+    }
+    else if (name == "tier")
+    {
+      costs.tierNanoseconds = nanoseconds;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+/**
+ * @brief make cache simulator
+ *
+ * Make the cache simulator described on the command line.  The levels
+ * are given from L1 down as a comma separated list of size:ways, where
+ * the size may have a K or M suffix, e.g. 32K:8,256K:4,8M:16.
+ *
+ * @param cacheLevels The description of the cache levels.
+ * @param lineBytes The size of the cache lines.
+ *
+ * @returns CacheSimulator* The new cache simulator, or NULL if the
+ *   description of the levels is not valid.
+ */
+CacheSimulator* makeCacheSimulator(const string& cacheLevels, int lineBytes)
+{
+  if (lineBytes < 1 or (lineBytes & (lineBytes - 1)) != 0)
+  {
+    return NULL;
+  }
+
+  CacheSimulator* cache = new CacheSimulator(lineBytes);
+  istringstream levels(cacheLevels);
+  string level;
+  while (getline(levels, level, ','))
+  {
+    size_t colon = level.find(':');
+    long sizeBytes = parseSize(level.substr(0, colon));
+    int ways = (colon == string::npos) ? 0 : atoi(level.substr(colon + 1).c_str());
+    long numSets = (ways > 0) ? sizeBytes / lineBytes / ways : 0;
+    if (numSets < 1 or numSets * lineBytes * ways != sizeBytes or (numSets & (numSets - 1)) != 0)
+    {
+      delete cache;
+      return NULL;
+    }
+    cache->addLevel(sizeBytes, ways);
+  }
+
+  if (cache->getNumLevels() == 0)
+  {
+    delete cache;
+    return NULL;
+  }
+  return cache;
+}
+
+
+/**
+ * @brief usage
+ *
+ * Display the command line usage of this program and exit.
+ */
+void usage()
+{
+  cerr << "Usage: ps04 [--frames n] [--policy fifo|lru|clock|opt] [--quiet] [--fault-log n] [--page-counts]" << endl
+       << "            [--size n] [--type int|double] [--layout row|column|tiled] [--page-size bytes] [--page-table-levels n]"
+       << endl
+       << "            [--prefetch sequential|stride|stream] [--prefetch-degree n]" << endl
+       << "            [--numa-nodes n] [--numa-placement first-touch|interleave] [--compressed-tier bytes]" << endl
+       << "            [--tlb n] [--tlb-ways n] [--tlb-asid] [--cache] [--cache-levels size:ways,...] [--cache-line bytes]"
+       << endl
+       << "            [--working-set delta] [--working-set-interval n] [--stack-distance]" << endl
+       << "            [--make-trace file row|column] [--record file row|column] [--replay file [--threads n]]" << endl
+       << "            [--load-control rate [--load-control-window n] [--quantum n]]" << endl
+       << "            [--kernels] [--kernel-tile n] [--measure [--drop-pages]] [--workers n] [--batch]" << endl
+       << "            [--arena-stats] [--clock] [--costs name=ns,...] [--disk-iops n]" << endl
+       << "            [--sweep file [--sweep-sizes n,...] [--sweep-page-sizes bytes,...] [--sweep-frames n,...]" << endl
+       << "                          [--sweep-policies p,...] [--sweep-loops row|column,...] [--threads n]]" << endl
+       << "  --frames n     number of physical frames to simulate (default " << DEFAULT_NUM_FRAMES << ")" << endl
+       << "  --policy p     page replacement policy to simulate (default lru)" << endl
+       << "  --quiet        do not display each page fault as it happens" << endl
+       << "  --fault-log n  log up to n page faults and display them with the results" << endl
+       << "  --page-counts  display the hits and faults of every page with the results" << endl
+       << "  --size n       number of rows and columns of the matrices (default 64)" << endl
+       << "  --type t       type of the matrix elements (default int)" << endl
+       << "  --layout l     layout of the matrices in memory, row or column major or " << TILE_SIZE << "x" << TILE_SIZE
+       << " tiles (default row)" << endl
+       << "  --page-size b  page size in bytes, may have a K or M suffix (default " << PAGE_SIZE_BYTES << ")" << endl
+       << "  --page-table-levels n  model n level page tables, reporting walk depth and table memory" << endl
+       << "  --prefetch p   prefetch pages with the sequential, stride or multiple stream prefetcher" << endl
+       << "  --prefetch-degree n  number of pages prefetched ahead (default " << DEFAULT_PREFETCH_DEGREE << ")" << endl
+       << "  --numa-nodes n split the frames into n NUMA nodes, the matrices running on the nodes in turn" << endl
+       << "  --numa-placement p  place new pages on the node of the matrix that first touches them, or" << endl
+       << "                 interleave them over the nodes (default first-touch)" << endl
+       << "  --compressed-tier b  compress replaced pages into a tier of b bytes before spilling them to disk" << endl
+       << "  --tlb n        simulate a TLB with n entries in front of the page table" << endl
+       << "  --tlb-ways n   number of ways of each set of the TLB, n for fully associative (default " << DEFAULT_TLB_WAYS << ")" << endl
+       << "  --tlb-asid     tag TLB entries with the matrix instead of flushing the TLB when the matrix changes" << endl
+       << "  --cache        also simulate the CPU caches (default " << cacheLevels << ")" << endl
+       << "  --cache-levels the size and ways of each cache level from L1 down, implies --cache" << endl
+       << "  --cache-line b size of the cache lines in bytes (default " << DEFAULT_CACHE_LINE_BYTES << ")" << endl
+       << "  --working-set delta     analyze the working set size with a window of delta references" << endl
+       << "  --working-set-interval n  also display the working set size and faults every n references" << endl
+       << "  --stack-distance  display the LRU page faults for every number of frames" << endl
+       << "  --make-trace   write the references of the row or column major matrix operations to a trace file" << endl
+       << "  --record       run the row or column major matrix operations recording their references to a trace file" << endl
+       << "  --replay file  replay the references of a trace file instead of the matrix operations, element" << endl
+       << "                 traces with the --page-size if given, otherwise the page size they were recorded with" << endl
+       << "  --threads n    replay with n threads, each process a shard with local replacement, or sweep with" << endl
+       << "                 n threads (default one for each core)" << endl
+       << "  --load-control rate  replay the processes of the trace in turn, without and then with load control"
+       << endl
+       << "                 suspending a process when the fault rate is above rate, resuming one below half of it" << endl
+       << "  --load-control-window n  number of references the fault rate is measured over (default "
+       << DEFAULT_LOAD_CONTROL_WINDOW << ")" << endl
+       << "  --quantum n    number of references each process runs for in turn (default " << DEFAULT_QUANTUM << ")"
+       << endl
+       << "  --kernels      run the tiled add, multiply and transpose kernels instead of the matrix operations," << endl
+       << "                 the int products of multiply wrap modulo 2^32 from size 128 on" << endl
+       << "  --kernel-tile n  number of rows and columns of the kernel tiles (default " << DEFAULT_KERNEL_TILE << ")"
+       << endl
+       << "  --measure      measure the real page faults of the matrix operations alongside the simulated faults,"
+       << endl
+       << "                 simulating the page size of this machine unless --page-size is given" << endl
+       << "  --drop-pages   drop the pages of the real matrices before measuring, so every page faults again" << endl
+       << "  --workers n    run the matrix operations in n workers sharing the matrices copy on write (at most "
+       << MAX_WORKERS << ")" << endl
+       << "  --batch        run the matrix operations element by element and by row or column ranges, simulating"
+       << endl
+       << "                 the references to each range as one batch, and compare the simulation times" << endl
+       << "  --arena-stats  display how much memory the arena the matrices are stored in mapped and reused" << endl
+       << "  --clock        display the minor and major faults, effective access time and simulated runtime" << endl
+       << "  --costs c      simulated nanoseconds of a hit, tlb-miss, minor fault, disk access and compressed tier"
+       << endl
+       << "                 load, e.g. hit=" << MEMORY_ACCESS_NANOSECONDS << ",tlb-miss=" << TLB_MISS_NANOSECONDS
+       << ",minor=" << MINOR_FAULT_NANOSECONDS << ",disk=" << DISK_PAGE_NANOSECONDS
+       << ",tier=" << COMPRESSED_PAGE_NANOSECONDS << " (the defaults), implies --clock" << endl
+       << "  --disk-iops n  limit the simulated disk to n pages a second, queueing the rest, implies --clock" << endl
+       << "  --sweep file   simulate the matrix operations for every combination of the swept sizes, page sizes," << endl
+       << "                 frames, policies and loop orders on a pool of threads, writing the results to a CSV file."
+       << endl
+       << "                 Parameters not swept take their single value, the loop orders default to both" << endl
+       << "  --sweep-sizes, --sweep-page-sizes, --sweep-frames, --sweep-policies, --sweep-loops" << endl
+       << "                 comma separated values of the parameters of the sweep" << endl;
+  exit(1);
+}
+
+
+/**
+ * @brief main entry
+ *
+ * Main entry point of process when run.  Code execution starts here.
+ * Whenever a process is created, it is initially created with a single
+ * thread.  The main() function starting point is the code that
+ * will initially be executing in the initial thread.
+ *
+ * @param argc The count of the number of arguments on the command line.
+ * @param argv[] An array of char* strings, the command line arguments
+ *   provided by the user when this program is run.
+ *
+ * @returns int Returns a status/exit code.  0 means normal termination.
+ */
+int main(int argc, char* argv[])
+{
+  // parse command line options
+  for (int arg = 1; arg < argc; arg++)
+  {
+    string option = argv[arg];
+    if (option == "--frames" and arg + 1 < argc)
+    {
+      numFrames = atoi(argv[++arg]);
+    }
+    else if (option == "--policy" and arg + 1 < argc)
+    {
+      policyName = argv[++arg];
+    }
+    else if (option == "--quiet")
+    {
+      MatrixBase::getPager()->setVerbose(false);
+    }
+    else if (option == "--fault-log" and arg + 1 < argc)
+    {
+      MatrixBase::getPager()->setFaultLogLimit(atoi(argv[++arg]));
+    }
+    else if (option == "--page-counts")
+    {
+      MatrixBase::getPager()->setDisplayPageCounts(true);
+    }
+    else if (option == "--size" and arg + 1 < argc)
+    {
+      SIZE = atoi(argv[++arg]);
+    }
+    else if (option == "--type" and arg + 1 < argc)
+    {
+      elementTypeName = argv[++arg];
+    }
+    else if (option == "--layout" and arg + 1 < argc)
+    {
+      layoutName = argv[++arg];
+    }
+    else if (option == "--page-size" and arg + 1 < argc)
+    {
+      long pageSizeBytes = parseSize(argv[++arg]);
+      if (not validPageSize(pageSizeBytes))
+      {
+        usage();
+      }
+      MatrixBase::getPager()->setPageSize(pageSizeBytes);
+      pageSizeGiven = true;
+    }
+    else if (option == "--page-table-levels" and arg + 1 < argc)
+    {
+      int levels = atoi(argv[++arg]);
+      if (levels < 0 or levels > MAX_PAGE_TABLE_LEVELS)
+      {
+        usage();
+      }
+      MatrixBase::getPager()->setPageTableLevels(levels);
+    }
+    else if (option == "--prefetch" and arg + 1 < argc)
+    {
+      prefetcherName = argv[++arg];
+    }
+    else if (option == "--prefetch-degree" and arg + 1 < argc)
+    {
+      prefetchDegree = atoi(argv[++arg]);
+      if (prefetchDegree < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--numa-nodes" and arg + 1 < argc)
+    {
+      numaNodes = atoi(argv[++arg]);
+      if (numaNodes < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--numa-placement" and arg + 1 < argc)
+    {
+      numaPlacementName = argv[++arg];
+    }
+    else if (option == "--compressed-tier" and arg + 1 < argc)
+    {
+      compressedTierBytes = parseSize(argv[++arg]);
+      if (compressedTierBytes < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--tlb" and arg + 1 < argc)
+    {
+      tlbEntries = atoi(argv[++arg]);
+    }
+    else if (option == "--tlb-ways" and arg + 1 < argc)
+    {
+      tlbWays = atoi(argv[++arg]);
+    }
+    else if (option == "--tlb-asid")
+    {
+      tlbAsidTagging = true;
+    }
+    else if (option == "--cache")
+    {
+      simulateCaches = true;
+    }
+    else if (option == "--cache-levels" and arg + 1 < argc)
+    {
+      simulateCaches = true;
+      cacheLevels = argv[++arg];
+    }
+    else if (option == "--cache-line" and arg + 1 < argc)
+    {
+      cacheLineBytes = atoi(argv[++arg]);
+    }
+    else if (option == "--working-set" and arg + 1 < argc)
+    {
+      workingSetWindow = atol(argv[++arg]);
+      if (workingSetWindow < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--working-set-interval" and arg + 1 < argc)
+    {
+      workingSetInterval = atol(argv[++arg]);
+      if (workingSetInterval < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--stack-distance")
+    {
+      analyzeStackDistance = true;
+    }
+    else if ((option == "--make-trace" or option == "--record") and arg + 2 < argc)
+    {
+      traceFileName = argv[++arg];
+      string loopOrderName = argv[++arg];
+      if (loopOrderName != "row" and loopOrderName != "column")
+      {
+        usage();
+      }
+      mode = (option == "--make-trace") ? MAKE_TRACE_MODE : RECORD_MODE;
+      traceLoopOrder = (loopOrderName == "row") ? ROW_MAJOR_LOOP : COLUMN_MAJOR_LOOP;
+    }
+    else if (option == "--threads" and arg + 1 < argc)
+    {
+      numThreads = atoi(argv[++arg]);
+      if (numThreads < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--load-control" and arg + 1 < argc)
+    {
+      loadControlRate = atof(argv[++arg]);
+      if (loadControlRate <= 0.0 or loadControlRate > 1.0)
+      {
+        usage();
+      }
+    }
+    else if (option == "--load-control-window" and arg + 1 < argc)
+    {
+      loadControlWindow = atol(argv[++arg]);
+      if (loadControlWindow < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--quantum" and arg + 1 < argc)
+    {
+      quantum = atoi(argv[++arg]);
+      if (quantum < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--measure")
+    {
+      mode = MEASURE_MODE;
+    }
+    else if (option == "--drop-pages")
+    {
+      dropPages = true;
+    }
+    else if (option == "--kernels")
+    {
+      mode = KERNEL_MODE;
+    }
+    else if (option == "--kernel-tile" and arg + 1 < argc)
+    {
+      kernelTileSize = atoi(argv[++arg]);
+      if (kernelTileSize < 1)
+      {
+        usage();
+      }
+    }
+    else if (option == "--workers" and arg + 1 < argc)
+    {
+      mode = SHARE_MODE;
+      numWorkers = atoi(argv[++arg]);
+      if (numWorkers < 1 or numWorkers > MAX_WORKERS)
+      {
+        usage();
+      }
+    }
+    else if (option == "--batch")
+    {
+      mode = BATCH_MODE;
+    }
+    else if (option == "--arena-stats")
+    {
+      displayArena = true;
+    }
+    else if (option == "--clock")
+    {
+      displayClock = true;
+    }
+    else if (option == "--costs" and arg + 1 < argc)
+    {
+      displayClock = true;
+      if (not parseCosts(argv[++arg], costModel))
+      {
+        usage();
+      }
+    }
+    else if (option == "--disk-iops" and arg + 1 < argc)
+    {
+      displayClock = true;
+      costModel.diskIops = atof(argv[++arg]);
+      if (costModel.diskIops <= 0.0)
+      {
+        usage();
+      }
+    }
+    else if (option == "--sweep" and arg + 1 < argc)
+    {
+      mode = SWEEP_MODE;
+      sweepFileName = argv[++arg];
+    }
+    else if (option == "--sweep-sizes" and arg + 1 < argc)
+    {
+      for (const string& item : splitList(argv[++arg]))
+      {
+        sweepSizes.push_back(atoi(item.c_str()));
+        if (sweepSizes.back() < 1)
+        {
+          usage();
+        }
+      }
+    }
+    else if (option == "--sweep-page-sizes" and arg + 1 < argc)
+    {
+      for (const string& item : splitList(argv[++arg]))
+      {
+        sweepPageSizes.push_back(parseSize(item));
+        if (not validPageSize(sweepPageSizes.back()))
+        {
+          usage();
+        }
+      }
+    }
+    else if (option == "--sweep-frames" and arg + 1 < argc)
+    {
+      for (const string& item : splitList(argv[++arg]))
+      {
+        sweepFrames.push_back(atoi(item.c_str()));
+        if (sweepFrames.back() < 1)
+        {
+          usage();
+        }
+      }
+    }
+    else if (option == "--sweep-policies" and arg + 1 < argc)
+    {
+      vector<PageReference> noReferences;
+      for (const string& item : splitList(argv[++arg]))
+      {
+        PageReplacementPolicy* policy = makeReplacementPolicy(item, noReferences);
+        if (policy == NULL)
+        {
+          usage();
+        }
+        delete policy;
+        sweepPolicies.push_back(item);
+      }
+    }
+    else if (option == "--sweep-loops" and arg + 1 < argc)
+    {
+      for (const string& item : splitList(argv[++arg]))
+      {
+        if (item != "row" and item != "column")
+        {
+          usage();
+        }
+        sweepLoopOrders.push_back((item == "row") ? ROW_MAJOR_LOOP : COLUMN_MAJOR_LOOP);
+      }
+    }
+    else if (option == "--replay" and arg + 1 < argc)
+    {
+      mode = REPLAY_MODE;
+      traceFileName = argv[++arg];
+    }
+    else
+    {
+      usage();
+    }
+  }
+
+  vector<PageReference> noReferences;
+  PageReplacementPolicy* policy = makeReplacementPolicy(policyName, noReferences);
+  if (numFrames < 1 or policy == NULL)
+  {
+    usage();
+  }
+  delete policy;
+
+  if (SIZE < 1)
+  {
+    usage();
+  }
+
+  if (numaPlacementName != "first-touch" and numaPlacementName != "interleave")
+  {
+    usage();
+  }
+  MatrixBase::getPager()->setNumaNodes(
+    numaNodes, (numaPlacementName == "interleave") ? INTERLEAVE_PLACEMENT : FIRST_TOUCH_PLACEMENT);
+
+  if (compressedTierBytes > 0)
+  {
+    MatrixBase::getPager()->setCompressedTier(compressedTierBytes);
+  }
+
+  // the concurrent replay has no simulated clock
+  if (displayClock and mode == REPLAY_MODE and numThreads > 0)
+  {
+    usage();
+  }
+  MatrixBase::getPager()->setCostModel(costModel);
+  MatrixBase::getPager()->setDisplayClock(displayClock);
+
+  if (tlbEntries > 0)
+  {
+    int tlbSets = (tlbWays > 0) ? tlbEntries / tlbWays : 0;
+    if (tlbWays < 1 or tlbEntries % tlbWays != 0 or (tlbSets & (tlbSets - 1)) != 0)
+    {
+      usage();
+    }
+    MatrixBase::getPager()->setTlb(tlbEntries, tlbWays, tlbAsidTagging);
+  }
+  else if (tlbEntries < 0)
+  {
+    usage();
+  }
+
+  // OPT expects every page loaded to be the next reference, so it
+  // can not be used with prefetching
+  if (not prefetcherName.empty())
+  {
+    Prefetcher* prefetcher = makePrefetcher(prefetcherName, prefetchDegree);
+    if (prefetcher == NULL or policyName == "opt" or numThreads > 0)
+    {
+      usage();
+    }
+    MatrixBase::getPager()->setPrefetcher(prefetcher);
+  }
+
+  if (workingSetWindow > 0)
+  {
+    MatrixBase::getPager()->addAnalyzer(new WorkingSetAnalyzer(workingSetWindow, workingSetInterval));
+  }
+  else if (workingSetInterval > 0)
+  {
+    usage();
+  }
+
+  if (analyzeStackDistance)
+  {
+    MatrixBase::getPager()->addAnalyzer(new StackDistanceAnalyzer());
+  }
+
+  if (simulateCaches)
+  {
+    CacheSimulator* cache = makeCacheSimulator(cacheLevels, cacheLineBytes);
+    if (cache == NULL)
+    {
+      usage();
+    }
+    MatrixBase::setCache(cache);
+  }
+
+  if (numThreads > 0 and mode != SWEEP_MODE and (mode != REPLAY_MODE or policyName == "opt"))
+  {
+    usage();
+  }
+
+  // the parameters not swept take the single value given for them
+  bool sweepGiven = not (sweepSizes.empty() and sweepPageSizes.empty() and sweepFrames.empty() and
+                         sweepPolicies.empty() and sweepLoopOrders.empty());
+  if (sweepGiven and mode != SWEEP_MODE)
+  {
+    usage();
+  }
+  if (sweepSizes.empty())
+  {
+    sweepSizes.push_back(SIZE);
+  }
+  if (sweepPageSizes.empty())
+  {
+    sweepPageSizes.push_back(MatrixBase::getPager()->getPageSize());
+  }
+  if (sweepFrames.empty())
+  {
+    sweepFrames.push_back(numFrames);
+  }
+  if (sweepPolicies.empty())
+  {
+    sweepPolicies.push_back(policyName);
+  }
+  if (sweepLoopOrders.empty())
+  {
+    sweepLoopOrders.push_back(COLUMN_MAJOR_LOOP);
+    sweepLoopOrders.push_back(ROW_MAJOR_LOOP);
+  }
+
+  if (mode == MEASURE_MODE and not pageSizeGiven)
+  {
+    MatrixBase::getPager()->setPageSize(getSystemPageSize());
+  }
+  if (dropPages and mode != MEASURE_MODE)
+  {
+    usage();
+  }
+
+  // OPT would need the reference string of the kernels, workers or ranges in advance
+  if ((mode == KERNEL_MODE or mode == SHARE_MODE or mode == BATCH_MODE) and policyName == "opt")
+  {
+    usage();
+  }
+
+  // load control reorders the references, which OPT can not follow
+  if (loadControlRate > 0.0 and (mode != REPLAY_MODE or numThreads > 0 or policyName == "opt"))
+  {
+    usage();
+  }
+
+  // replaying a trace creates no matrices
+  if (displayArena and mode == REPLAY_MODE)
+  {
+    usage();
+  }
+
+  if (mode == REPLAY_MODE and numThreads > 0)
+  {
+    replayTraceConcurrently(traceFileName, numThreads);
+  }
+  else if (mode == REPLAY_MODE and loadControlRate > 0.0)
+  {
+    replayWithLoadControl(traceFileName);
+  }
+  else if (mode == REPLAY_MODE)
+  {
+    replayTrace(traceFileName);
+  }
+  else if (elementTypeName == "int")
+  {
+    if (not runWithLayout<int>())
+    {
+      usage();
+    }
+  }
+  else if (elementTypeName == "double")
+  {
+    if (not runWithLayout<double>())
+    {
+      usage();
+    }
+  }
+  else
+  {
+    usage();
+  }
+
+  if (displayArena)
+  {
+    MatrixBase::getArena()->displayResults(cout);
+  }
+
   // return 0 to indicate successful completion
   return 0;
 }